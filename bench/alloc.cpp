@@ -0,0 +1,42 @@
+#include "bench.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+//--Allocation counter (operator new + libxml2 allocator)
+static std::atomic<size_t> allocs{0};
+
+void *operator new(size_t n) {
+    allocs.fetch_add(1,std::memory_order_relaxed);
+    if(auto p = std::malloc(n == 0 ? 1 : n)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p,size_t) noexcept {
+    std::free(p);
+}
+
+static void *CountMalloc(size_t n) {
+    allocs.fetch_add(1,std::memory_order_relaxed);
+    return std::malloc(n);
+}
+static void *CountRealloc(void *p,size_t n) {
+    allocs.fetch_add(1,std::memory_order_relaxed);
+    return std::realloc(p,n);
+}
+static char *CountStrdup(const char *s) {
+    allocs.fetch_add(1,std::memory_order_relaxed);
+    return strdup(s);
+}
+
+size_t Bench::Allocations() {
+    return allocs.load(std::memory_order_relaxed);
+}
+void Bench::CountAllocations() {
+    xmlMemSetup(std::free,CountMalloc,CountRealloc,CountStrdup);
+}
@@ -0,0 +1,60 @@
+#include "../bench.hpp"
+#include <memory>
+
+template<class Doc>
+static void RunTeardown(const char *name,const std::string &xml) {
+    if(!Bench::Enabled(name)){
+        return;
+    }
+    double parse = 0;
+    double teardown = 0;
+    size_t n = 10;
+    for(size_t i = 0;i < n;i++){
+        auto start = std::chrono::steady_clock::now();
+        auto doc = std::make_unique<Doc>(Doc::Parse(xml));
+        auto mid = std::chrono::steady_clock::now();
+        doc.reset();
+        auto end = std::chrono::steady_clock::now();
+        parse += std::chrono::duration<double,std::milli>(mid - start).count();
+        teardown += std::chrono::duration<double,std::milli>(end - mid).count();
+    }
+    Bench::Report(name,{
+        {"parse_ms",parse / n},
+        {"teardown_ms",teardown / n},
+        {"mb_per_s",xml.size() * double(n) / (parse / 1e3) / 1e6}
+    });
+}
+
+//Parse and teardown time of the heap and arena documents
+BENCH_GROUP(arena) {
+    auto xml = Bench::MakeXml(100000);
+    RunTeardown<LXml::XmlDocument>("XmlDocument",xml);
+    RunTeardown<LXml::XmlArenaDocument>("XmlArenaDocument",xml);
+}
+
+//Building 100000 rows with DocumentBuilder,the nodes come from the arena slab
+BENCH_GROUP(arena_builder) {
+    const size_t rows = 100000;
+    Bench::Run("DocumentBuilder(XmlArenaDocument)",0,[&](){
+        auto doc = LXml::XmlArenaDocument::New();
+        LXml::DocumentBuilder builder(doc);
+        builder.start_element("rows");
+        for(size_t i = 0;i < rows;i++){
+            builder.start_element("row");
+            builder.attribute("id",i);
+            builder.text("Text of the row");
+            builder.end_element();
+        }
+        Bench::DoNotOptimize(doc.get());
+    });
+}
+
+//Usage: bench_arena [filter]
+//The arena allocator has to be installed before any libxml2 call and stays for the whole process,
+//so these benchmarks don't share the process with the heap ones
+int main(int argc,char **argv){
+    Bench::CountAllocations();
+    LXml::Arena::Install();
+    LXml::Library lib;
+    return Bench::RunGroups(argc,argv);
+}
@@ -0,0 +1,88 @@
+#include "bench.hpp"
+
+#if LXML_CXX20
+#include <coroutine>
+#include <deque>
+
+namespace {
+
+//Single thread round robin loop,a stream read suspends until the loop comes back to it
+struct Loop {
+    std::deque<std::coroutine_handle<>> ready;
+
+    void run() {
+        while(!ready.empty()){
+            auto h = ready.front();
+            ready.pop_front();
+            h.resume();
+        }
+    }
+};
+//In memory stream acting like a socket,every read suspends once
+class LoopStream {
+    public:
+        LoopStream(Loop &loop,LXml::u8string_view data,size_t chunk_size) :
+            loop(loop), data(data), chunk_size(chunk_size) {}
+
+        auto read_some() {
+            struct Awaiter {
+                LoopStream *self;
+
+                bool await_ready() const noexcept {
+                    return false;
+                }
+                void await_suspend(std::coroutine_handle<> h) const {
+                    self->loop.ready.push_back(h);
+                }
+                LXml::u8string_view await_resume() const noexcept {
+                    auto chunk = self->data.substr(0,self->chunk_size);
+                    self->data.remove_prefix(chunk.size());
+                    return chunk;
+                }
+            };
+            return Awaiter{this};
+        }
+    private:
+        Loop               &loop;
+        LXml::u8string_view data;
+        size_t              chunk_size;
+};
+
+}
+
+//Interleaved async parses on one thread: documents of 1000 items read in 4KB chunks
+BENCH_GROUP(async) {
+    auto xml = Bench::MakeXml(1000);
+
+    Bench::Run("XmlDocument::Parse",xml.size(),[&](){
+        auto doc = LXml::XmlDocument::Parse(xml);
+        Bench::DoNotOptimize(doc.get());
+    });
+    Bench::Run("AsyncParse/MemoryStream",xml.size(),[&](){
+        LXml::MemoryStream stream(xml,4096);
+        auto task = LXml::AsyncParse(stream);
+        task.start();
+        auto doc = task.result();
+        Bench::DoNotOptimize(doc.get());
+    });
+    for(size_t in_flight : {1,16,256,1024}){
+        auto name = "AsyncParse/in flight " + std::to_string(in_flight);
+        Bench::Run(name.c_str(),xml.size() * in_flight,[&](){
+            Loop loop;
+            std::vector<LoopStream> streams;
+            std::vector<LXml::AsyncTask<LXml::XmlDocument>> tasks;
+            streams.reserve(in_flight);
+            tasks.reserve(in_flight);
+            for(size_t i = 0;i < in_flight;i++){
+                streams.emplace_back(loop,xml,4096);
+                tasks.push_back(LXml::AsyncParse(streams.back()));
+                tasks.back().start();
+            }
+            loop.run();
+            for(auto &task : tasks){
+                Bench::DoNotOptimize(task.result().get());
+            }
+        });
+    }
+}
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "../include/lxml.hpp"
+#include <initializer_list>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//--Benchmark harness
+//  Every case prints one JSON object per line:
+//  {"group":"parse","name":"XmlDocument::Parse/small","ns_per_op":1.0,"mb_per_s":1.0,"allocs_per_op":1.0,...}
+namespace Bench {
+
+using Group = void (*)();
+struct Metric {
+    const char *name;
+    double      value;
+};
+
+/**
+ * @brief Count of allocations (operator new + libxml2 allocator),defined in main.cpp
+ *
+ */
+size_t Allocations();
+/**
+ * @brief Route the libxml2 allocator through the counter,call it before any libxml2 call
+ *
+ */
+void CountAllocations();
+
+inline std::vector<std::pair<const char *,Group>> &Groups() {
+    static std::vector<std::pair<const char *,Group>> groups;
+    return groups;
+}
+inline const char *&CurrentGroup() {
+    static const char *group = "";
+    return group;
+}
+inline std::string &Filter() {
+    static std::string filter;
+    return filter;
+}
+inline bool Enabled(const char *name) {
+    auto &filter = Filter();
+    if(filter.empty()){
+        return true;
+    }
+    return std::string(CurrentGroup()).find(filter) != std::string::npos ||
+           std::string(name).find(filter) != std::string::npos;
+}
+struct Register {
+    Register(const char *name,Group group) {
+        Groups().emplace_back(name,group);
+    }
+};
+/**
+ * @brief Run the registered groups,argv[1] is the optional filter
+ *
+ */
+inline int RunGroups(int argc,char **argv) {
+    if(argc > 1){
+        Filter() = argv[1];
+    }
+    for(auto &group : Groups()){
+        CurrentGroup() = group.first;
+        group.second();
+    }
+    return 0;
+}
+
+/**
+ * @brief Print a result line
+ *
+ */
+inline void Report(const char *name,std::initializer_list<Metric> metrics) {
+    std::printf("{\"group\":\"%s\",\"name\":\"%s\"",CurrentGroup(),name);
+    for(auto &metric : metrics){
+        std::printf(",\"%s\":%.3f",metric.name,metric.value);
+    }
+    std::printf("}\n");
+    std::fflush(stdout);
+}
+
+template<class T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Run fn repeatedly (calibrated to about 100ms) and report ns/op,MB/s and allocs/op
+ *
+ * @param bytes Bytes processed per op,0 on none
+ */
+template<class Fn>
+inline void Run(const char *name,size_t bytes,Fn &&fn) {
+    using Clock = std::chrono::steady_clock;
+    if(!Enabled(name)){
+        return;
+    }
+    //Warmup and calibrate
+    auto   start = Clock::now();
+    fn();
+    double once = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t n = once <= 0 ? 1000000 : size_t(0.1 / once);
+    if(n < 1){
+        n = 1;
+    }
+    if(n > 1000000){
+        n = 1000000;
+    }
+
+    size_t before = Allocations();
+    start = Clock::now();
+    for(size_t i = 0;i < n;i++){
+        fn();
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t allocs = Allocations() - before;
+    Report(name,{
+        {"ns_per_op",sec * 1e9 / n},
+        {"mb_per_s",bytes == 0 ? 0.0 : bytes * double(n) / sec / 1e6},
+        {"allocs_per_op",double(allocs) / n},
+        {"iterations",double(n)}
+    });
+}
+
+//--Synthetic inputs
+/**
+ * @brief Catalog like xml,n items,about 110 bytes per item
+ *
+ */
+inline std::string MakeXml(size_t n) {
+    std::string str = "<?xml version=\"1.0\"?><root>";
+    for(size_t i = 0;i < n;i++){
+        str += "<catalog-item-entry id=\"catalog-item-" + std::to_string(i) + "\" class=\"entry\">";
+        str += "Text of the catalog item " + std::to_string(i) + "</catalog-item-entry>";
+    }
+    str += "</root>";
+    return str;
+}
+/**
+ * @brief Page like html,n blocks of links and paragraphs
+ *
+ */
+inline std::string MakeHtml(size_t n) {
+    std::string str = "<!DOCTYPE html><html><head><title>Bench</title></head><body>";
+    for(size_t i = 0;i < n;i++){
+        std::string id = std::to_string(i);
+        str += "<div class=\"item row\" id=\"item-" + id + "\">";
+        str += "<a href=\"/item/" + id + "\" class=\"link\">Item " + id + "</a>";
+        str += "<p>Paragraph of the item " + id + " with <b>bold</b> text</p>";
+        str += "</div>";
+    }
+    str += "</body></html>";
+    return str;
+}
+//Sizes used by the parse benchmarks
+inline const std::vector<std::pair<const char *,size_t>> &Sizes() {
+    static const std::vector<std::pair<const char *,size_t>> sizes = {
+        {"small",10},
+        {"medium",1000},
+        {"huge",100000},
+    };
+    return sizes;
+}
+
+}
+
+#define BENCH_GROUP(NAME) \
+    static void Bench_##NAME(); \
+    static Bench::Register Bench_##NAME##_register(#NAME,Bench_##NAME); \
+    static void Bench_##NAME()
@@ -0,0 +1,98 @@
+#include "bench.hpp"
+#include <string>
+
+namespace {
+
+struct Order {
+    int         id = 0;
+    int         quantity = 0;
+    double      price = 0;
+    bool        paid = false;
+    std::string customer;
+    std::string sku;
+
+    static constexpr auto lxml_binding = LXml::Binding(
+        LXml::BindAttribute("id",&Order::id),
+        LXml::BindAttribute("paid",&Order::paid),
+        LXml::BindElement("customer",&Order::customer),
+        LXml::BindElement("sku",&Order::sku),
+        LXml::BindElement("quantity",&Order::quantity),
+        LXml::BindElement("price",&Order::price)
+    );
+};
+
+std::string MakeOrders(size_t n) {
+    std::string str = "<?xml version=\"1.0\"?><orders>";
+    for(size_t i = 0;i < n;i++){
+        auto id = std::to_string(i);
+        str += "<order id=\"" + id + "\" paid=\"" + (i % 2 ? "true" : "false") + "\">";
+        str += "<customer>customer-" + id + "</customer><sku>SKU-" + id + "</sku>";
+        str += "<quantity>" + std::to_string(i % 17) + "</quantity><price>" + std::to_string(i) + ".25</price>";
+        str += "</order>";
+    }
+    str += "</orders>";
+    return str;
+}
+
+}
+
+//Filling structs from 10000 records: hand written accessors + stoi against Bind()
+BENCH_GROUP(bind) {
+    auto xml = MakeOrders(10000);
+    auto doc = LXml::XmlDocument::Parse(xml);
+    auto root = doc.root_node();
+
+    Bench::Run("hand written (xpath + attribute + content + stoi)",xml.size(),[&](){
+        std::vector<Order> orders;
+        auto obj = root.xpath("order");
+        for(auto node : obj.as_nodeset()){
+            Order order;
+            order.id = std::stoi(node.attribute("id").to_string());
+            order.paid = node.attribute("paid").view() == "true";
+            for(auto child : node.children()){
+                if(!child.is_element()){
+                    continue;
+                }
+                auto name = child.name();
+                if(name == "customer"){
+                    order.customer = child.content().to_string();
+                }
+                else if(name == "sku"){
+                    order.sku = child.content().to_string();
+                }
+                else if(name == "quantity"){
+                    order.quantity = std::stoi(child.content().to_string());
+                }
+                else if(name == "price"){
+                    order.price = std::stod(child.content().to_string());
+                }
+            }
+            orders.push_back(std::move(order));
+        }
+        Bench::DoNotOptimize(orders.size());
+    });
+    Bench::Run("Bind<Order>()",xml.size(),[&](){
+        std::vector<Order> orders;
+        for(auto node : root.elements()){
+            orders.push_back(LXml::Bind<Order>(node));
+        }
+        Bench::DoNotOptimize(orders.size());
+    });
+    Bench::Run("XmlReader + BindEach<Order>()",xml.size(),[&](){
+        auto   reader = LXml::XmlReader::Parse(xml);
+        double total = 0;
+        LXml::BindEach<Order>(reader,"order",[&](Order &&order){
+            total += order.price * order.quantity;
+        });
+        Bench::DoNotOptimize(total);
+    });
+    Bench::Run("XmlDocument::Parse + Bind<Order>()",xml.size(),[&](){
+        auto   doc = LXml::XmlDocument::Parse(xml);
+        double total = 0;
+        for(auto node : doc.root_node().elements()){
+            auto order = LXml::Bind<Order>(node);
+            total += order.price * order.quantity;
+        }
+        Bench::DoNotOptimize(total);
+    });
+}
@@ -0,0 +1,332 @@
+#include "bench.hpp"
+
+static size_t Walk(LXml::NodeRef node) {
+    size_t n = 1;
+    for(auto child : node.children()){
+        n += Walk(child);
+    }
+    return n;
+}
+
+//Traversal,iteration,attribute and serialization over a medium document
+BENCH_GROUP(dom) {
+    auto xml  = Bench::MakeXml(1000);
+    auto doc  = LXml::XmlDocument::Parse(xml);
+    auto root = doc.root_node();
+
+    Bench::Run("traversal(recursive)",xml.size(),[&](){
+        Bench::DoNotOptimize(Walk(root));
+    });
+    Bench::Run("children()",0,[&](){
+        size_t n = 0;
+        for(auto child : root.children()){
+            n += child.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("attribute()",0,[&](){
+        size_t n = 0;
+        for(auto child : root.children()){
+            n += child.attribute("class").size();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("to_string()",xml.size(),[&](){
+        Bench::DoNotOptimize(doc.to_string(false).size());
+    });
+    Bench::Run("to_string(format)",xml.size(),[&](){
+        Bench::DoNotOptimize(doc.to_string(true).size());
+    });
+    Bench::Run("xmlDocDumpFormatMemory()",xml.size(),[&](){
+        xmlChar *text;
+        int      size;
+        xmlDocDumpFormatMemory(doc.get(),&text,&size,0);
+        LXml::u8string str(reinterpret_cast<char *>(text),size);
+        xmlFree(text);
+        Bench::DoNotOptimize(str.size());
+    });
+    Bench::Run("write_to(callback)",xml.size(),[&](){
+        size_t n = 0;
+        doc.write_to(LXml::OutputSink([&](LXml::u8string_view chunk){
+            n += chunk.size();
+            return true;
+        }),false);
+        Bench::DoNotOptimize(n);
+    });
+}
+
+template<class Fn>
+static void ForEachElement(LXml::NodeRef node,Fn &fn) {
+    for(auto child : node.children()){
+        if(child.is_element()){
+            fn(child);
+            ForEachElement(child,fn);
+        }
+    }
+}
+
+//Link extractor: href/class/id of every element in a medium html page
+BENCH_GROUP(attributes) {
+    auto html = Bench::MakeHtml(1000);
+    auto doc  = LXml::HtmlDocument::Parse(html);
+    auto root = doc.root_node();
+
+    Bench::Run("xmlGetProp() copy",html.size(),[&](){
+        size_t n = 0;
+        auto fn = [&](LXml::NodeRef node){
+            for(auto name : {"href","class","id"}){
+                n += LXml::ToString(xmlGetProp(node.get(),BAD_CAST name)).size();
+            }
+        };
+        ForEachElement(root,fn);
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("attribute()",html.size(),[&](){
+        size_t n = 0;
+        auto fn = [&](LXml::NodeRef node){
+            for(auto name : {"href","class","id"}){
+                n += node.attribute(name).size();
+            }
+        };
+        ForEachElement(root,fn);
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("attribute_view()",html.size(),[&](){
+        size_t n = 0;
+        auto fn = [&](LXml::NodeRef node){
+            for(auto name : {"href","class","id"}){
+                n += node.attribute_view(name).size();
+            }
+        };
+        ForEachElement(root,fn);
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("attributes()",html.size(),[&](){
+        size_t n = 0;
+        auto fn = [&](LXml::NodeRef node){
+            for(auto attr : node.attributes()){
+                n += attr.value.size();
+            }
+        };
+        ForEachElement(root,fn);
+        Bench::DoNotOptimize(n);
+    });
+}
+
+//Tag matching: count the <a> elements of a medium html page
+BENCH_GROUP(names) {
+    auto html = Bench::MakeHtml(1000);
+    auto doc  = LXml::HtmlDocument::Parse(html);
+    auto root = doc.root_node();
+
+    Bench::Run("name() == a",html.size(),[&](){
+        size_t n = 0;
+        auto fn = [&](LXml::NodeRef node){
+            n += node.name() == "a";
+        };
+        ForEachElement(root,fn);
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("name_view() == a",html.size(),[&](){
+        size_t n = 0;
+        auto fn = [&](LXml::NodeRef node){
+            n += node.name_view() == "a";
+        };
+        ForEachElement(root,fn);
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("is(Name)",html.size(),[&](){
+        size_t n = 0;
+        auto a  = doc.intern("a");
+        auto fn = [&](LXml::NodeRef node){
+            n += node.is(a);
+        };
+        ForEachElement(root,fn);
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("children_named(Name)",html.size(),[&](){
+        size_t n = 0;
+        auto div = doc.intern("div");
+        auto a   = doc.intern("a");
+        for(auto body : root.children_named(doc.intern("body"))){
+            for(auto item : body.children_named(div)){
+                for(auto link : item.children_named(a)){
+                    n += link.is_element();
+                }
+            }
+        }
+        Bench::DoNotOptimize(n);
+    });
+}
+
+//Descendant walk against the equivalent //tag xpath,first match and full scan
+BENCH_GROUP(traversal) {
+    auto html = Bench::MakeHtml(1000);
+    auto doc  = LXml::HtmlDocument::Parse(html);
+    auto root = doc.root_node();
+    auto a    = doc.intern("a");
+
+    Bench::Run("xpath(//a) first",html.size(),[&](){
+        auto obj = root.xpath("//a");
+        Bench::DoNotOptimize(obj.as_nodeset()[0].get());
+    });
+    Bench::Run("descendants(filter).first()",html.size(),[&](){
+        auto node = root.descendants([&](LXml::NodeRef n){ return n.is(a); }).first();
+        Bench::DoNotOptimize(node.get());
+    });
+    Bench::Run("xpath(//a) scan",html.size(),[&](){
+        size_t n = 0;
+        auto   obj = root.xpath("//a");
+        for(auto node : obj.as_nodeset()){
+            n += node.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("descendants(filter) scan",html.size(),[&](){
+        size_t n = 0;
+        for(auto node : root.descendants([&](LXml::NodeRef n){ return n.is(a); })){
+            n += node.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("xpath(//*) scan",html.size(),[&](){
+        size_t n = 0;
+        auto   obj = root.xpath("//*");
+        for(auto node : obj.as_nodeset()){
+            n += node.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("descendants() scan",html.size(),[&](){
+        size_t n = 0;
+        for(auto node : root.descendants()){
+            n += node.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("elements()",0,[&](){
+        size_t n = 0;
+        for(auto body : root.elements()){
+            for(auto node : body.elements()){
+                n += node.is_element();
+            }
+        }
+        Bench::DoNotOptimize(n);
+    });
+}
+
+//FrozenDocument against the live dom on a medium html page
+BENCH_GROUP(frozen) {
+    auto html   = Bench::MakeHtml(1000);
+    auto doc    = LXml::HtmlDocument::Parse(html);
+    auto root   = doc.root_node();
+    auto frozen = doc.freeze();
+    auto froot  = frozen.root_node();
+
+    Bench::Run("freeze()",html.size(),[&](){
+        Bench::DoNotOptimize(doc.freeze().size());
+    });
+    Bench::Run("live descendants()",html.size(),[&](){
+        size_t n = 0;
+        for(auto node : root.descendants()){
+            n += node.name_view().size();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("frozen descendants()",html.size(),[&](){
+        size_t n = 0;
+        for(auto node : froot.descendants()){
+            n += node.name_view().size();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("live children() x2",0,[&](){
+        size_t n = 0;
+        for(auto body : root.elements()){
+            for(auto item : body.elements()){
+                for(auto child : item.children()){
+                    n += child.is_element();
+                }
+            }
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("frozen children() x2",0,[&](){
+        size_t n = 0;
+        for(auto body : froot.elements()){
+            for(auto item : body.elements()){
+                for(auto child : item.children()){
+                    n += child.is_element();
+                }
+            }
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("live attribute_view(href)",html.size(),[&](){
+        size_t n = 0;
+        auto a = doc.intern("a");
+        for(auto node : root.descendants([&](LXml::NodeRef n){ return n.is(a); })){
+            n += node.attribute_view("href").size();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("frozen attribute_view(href)",html.size(),[&](){
+        size_t n = 0;
+        for(auto node : froot.descendants("a")){
+            n += node.attribute_view("href").size();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("xpath(//div/p/b)",0,[&](){
+        auto obj = root.xpath("//div/p/b");
+        Bench::DoNotOptimize(obj.as_nodeset().size());
+    });
+    Bench::Run("frozen query(//div/p/b)",0,[&](){
+        Bench::DoNotOptimize(frozen.query("//div/p/b").size());
+    });
+    Bench::Report("memory",{
+        {"source_bytes",double(html.size())},
+        {"frozen_bytes",double(frozen.memory_usage())},
+        {"nodes",double(frozen.size())}
+    });
+}
+
+//Building 100000 rows (element + attribute + text): Node::New + xmlAddChild against DocumentBuilder
+BENCH_GROUP(builder) {
+    const size_t rows = 100000;
+    Bench::Run("Node::New + set_attribute + set_content",0,[&](){
+        auto doc = LXml::XmlDocument::New();
+        doc.set_root(LXml::Node::New("rows"));
+        auto root = doc.root_node();
+        for(size_t i = 0;i < rows;i++){
+            auto row = LXml::Node::New("row");
+            row.set_attribute("id",std::to_string(i));
+            row.set_content("Text of the row");
+            xmlAddChild(root.get(),row.detach());
+        }
+        Bench::DoNotOptimize(doc.get());
+    });
+    Bench::Run("create_element + set_attribute + set_content",0,[&](){
+        auto doc = LXml::XmlDocument::New();
+        doc.set_root(LXml::Node::New("rows"));
+        auto root = doc.root_node();
+        for(size_t i = 0;i < rows;i++){
+            auto row = root.create_element("row");
+            row.set_attribute("id",std::to_string(i));
+            row.set_content("Text of the row");
+        }
+        Bench::DoNotOptimize(doc.get());
+    });
+    Bench::Run("DocumentBuilder",0,[&](){
+        auto doc = LXml::XmlDocument::New();
+        LXml::DocumentBuilder builder(doc);
+        builder.start_element("rows");
+        for(size_t i = 0;i < rows;i++){
+            builder.start_element("row");
+            builder.attribute("id",i);
+            builder.text("Text of the row");
+            builder.end_element();
+        }
+        Bench::DoNotOptimize(doc.get());
+    });
+}
@@ -0,0 +1,9 @@
+#include "bench.hpp"
+
+//Usage: bench [filter],only the groups or cases whose name contains filter are run
+//The arena benchmarks are in bench_arena,its allocator stays installed for the whole process
+int main(int argc,char **argv){
+    Bench::CountAllocations();
+    LXml::Library lib;
+    return Bench::RunGroups(argc,argv);
+}
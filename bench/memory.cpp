@@ -0,0 +1,66 @@
+#include "bench.hpp"
+#include <fstream>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//Run fn in a child process,so every case starts with a fresh peak RSS
+template<class Fn>
+static void RunProcess(const char *name,Fn &&fn) {
+    if(!Bench::Enabled(name)){
+        return;
+    }
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if(pid == 0){
+        struct rusage usage;
+        getrusage(RUSAGE_SELF,&usage);
+        long before = usage.ru_maxrss;
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        getrusage(RUSAGE_SELF,&usage);
+        Bench::Report(name,{
+            {"ms",std::chrono::duration<double,std::milli>(end - start).count()},
+            {"peak_rss_kb",double(usage.ru_maxrss - before)}
+        });
+        _exit(0);
+    }
+    waitpid(pid,nullptr,0);
+}
+
+//Wall time and peak RSS of parsing a file
+BENCH_GROUP(file) {
+    const char *path = "/tmp/lxml_bench.xml";
+    {
+        std::ofstream file(path);
+        file << "<root>";
+        for(size_t i = 0;i < 400000;i++){
+            file << "<catalog-item-entry id=\"catalog-item-" << i << "\" class=\"entry\">";
+            file << "Text of the catalog item " << i << "</catalog-item-entry>";
+        }
+        file << "</root>";
+    }
+    RunProcess("Parse(read into string)",[&](){
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        auto str = stream.str();
+        auto doc = LXml::XmlDocument::Parse(str);
+        Bench::DoNotOptimize(doc.get());
+    });
+    RunProcess("ParseFile(mmap)",[&](){
+        auto doc = LXml::XmlDocument::ParseFile(path);
+        Bench::DoNotOptimize(doc.get());
+    });
+    RunProcess("XmlReader(expand records)",[&](){
+        auto   reader = LXml::XmlReader::ParseFile(path);
+        size_t n = 0;
+        while(reader.next_element("catalog-item-entry")){
+            n += reader.expand().content().size();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    std::remove(path);
+}
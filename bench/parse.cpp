@@ -0,0 +1,160 @@
+#include "bench.hpp"
+#include <thread>
+#include <atomic>
+
+//Parse throughput of the synthetic documents at each size
+BENCH_GROUP(parse) {
+    for(auto &size : Bench::Sizes()){
+        auto xml  = Bench::MakeXml(size.second);
+        auto name = std::string("XmlDocument::Parse/") + size.first;
+        Bench::Run(name.c_str(),xml.size(),[&](){
+            auto doc = LXml::XmlDocument::Parse(xml);
+            Bench::DoNotOptimize(doc.get());
+        });
+    }
+    for(auto &size : Bench::Sizes()){
+        auto html = Bench::MakeHtml(size.second);
+        auto name = std::string("HtmlDocument::Parse/") + size.first;
+        Bench::Run(name.c_str(),html.size(),[&](){
+            auto doc = LXml::HtmlDocument::Parse(html);
+            Bench::DoNotOptimize(doc.get());
+        });
+    }
+    for(auto &size : Bench::Sizes()){
+        auto xml  = Bench::MakeXml(size.second);
+        auto name = std::string("XmlPushParser/") + size.first;
+        Bench::Run(name.c_str(),xml.size(),[&](){
+            LXml::XmlPushParser parser;
+            for(size_t i = 0;i < xml.size();i += 4096){
+                parser.feed(LXml::u8string_view(xml).substr(i,4096));
+            }
+            auto doc = parser.finish();
+            Bench::DoNotOptimize(doc.get());
+        });
+    }
+}
+
+//ParseBatch scaling from 1 to hardware_concurrency threads
+BENCH_GROUP(batch) {
+    std::vector<std::string> docs;
+    for(size_t i = 0;i < 2000;i++){
+        docs.push_back(Bench::MakeXml(50 + i % 50));
+    }
+    std::vector<LXml::u8string_view> views(docs.begin(),docs.end());
+    size_t bytes = 0;
+    for(auto &doc : docs){
+        bytes += doc.size();
+    }
+    size_t max_threads = std::thread::hardware_concurrency();
+    if(max_threads == 0){
+        max_threads = 1;
+    }
+    for(size_t threads = 1;threads <= max_threads;threads++){
+        auto name = "ParseBatch/" + std::to_string(threads);
+        Bench::Run(name.c_str(),bytes,[&](){
+            auto results = LXml::ParseBatch(views,threads);
+            Bench::DoNotOptimize(results.data());
+        });
+    }
+}
+
+//Record oriented document: single threaded parse against ParseRecords from 1 to hardware_concurrency threads
+BENCH_GROUP(records) {
+    auto xml = Bench::MakeXml(100000);
+    size_t max_threads = std::thread::hardware_concurrency();
+    if(max_threads == 0){
+        max_threads = 1;
+    }
+
+    Bench::Run("ScanRecords()",xml.size(),[&](){
+        Bench::DoNotOptimize(LXml::ScanRecords(xml,"catalog-item-entry").records.size());
+    });
+    Bench::Run("XmlDocument::Parse + elements()",xml.size(),[&](){
+        auto   doc = LXml::XmlDocument::Parse(xml);
+        size_t n = 0;
+        for(auto record : doc.root_node().elements()){
+            n += record.attribute_view("id").size();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    for(size_t threads = 1;threads <= max_threads;threads *= 2){
+        auto name = "ParseRecords/" + std::to_string(threads);
+        Bench::Run(name.c_str(),xml.size(),[&](){
+            std::atomic<size_t> n {0};
+            LXml::ParseRecords(xml,"catalog-item-entry",[&](LXml::NodeRef record,size_t){
+                n.fetch_add(record.attribute_view("id").size(),std::memory_order_relaxed);
+            },threads);
+            Bench::DoNotOptimize(n.load());
+        });
+    }
+}
+
+//Small messages: a new context per parse against a reused ParserContext
+BENCH_GROUP(context) {
+    std::vector<std::string> messages;
+    for(size_t i = 0;i < 64;i++){
+        auto id = std::to_string(i);
+        messages.push_back(
+            "<?xml version=\"1.0\"?><message id=\"" + id + "\" type=\"order\">"
+            "<header><sender>client-" + id + "</sender><timestamp>2024-01-01T00:00:00</timestamp></header>"
+            "<body><item sku=\"A-" + id + "\" qty=\"2\"/><item sku=\"B-" + id + "\" qty=\"1\"/></body></message>"
+        );
+    }
+    size_t bytes = 0;
+    for(auto &msg : messages){
+        bytes += msg.size();
+    }
+
+    Bench::Run("XmlDocument::Parse/64 messages",bytes,[&](){
+        for(auto &msg : messages){
+            auto doc = LXml::XmlDocument::Parse(msg);
+            Bench::DoNotOptimize(doc.get());
+        }
+    });
+    LXml::XmlParserContext ctxt;
+    Bench::Run("XmlParserContext::parse/64 messages",bytes,[&](){
+        for(auto &msg : messages){
+            auto doc = ctxt.parse(msg);
+            Bench::DoNotOptimize(doc.get());
+        }
+    });
+    Bench::Run("HtmlDocument::Parse/64 messages",bytes,[&](){
+        for(auto &msg : messages){
+            auto doc = LXml::HtmlDocument::Parse(msg);
+            Bench::DoNotOptimize(doc.get());
+        }
+    });
+    LXml::HtmlParserContext html;
+    Bench::Run("HtmlParserContext::parse/64 messages",bytes,[&](){
+        for(auto &msg : messages){
+            auto doc = html.parse(msg);
+            Bench::DoNotOptimize(doc.get());
+        }
+    });
+}
+
+//Structural prescan: stage 1 per instruction set,full index and tag counting
+BENCH_GROUP(structural) {
+    using Isa = LXml::StructuralIndex::Isa;
+    auto xml = Bench::MakeXml(100000);
+    std::vector<std::pair<const char *,Isa>> isas = {{"Scalar",Isa::Scalar}};
+#if LXML_SIMD_X86
+    isas.emplace_back("SSE2",Isa::SSE2);
+    if(LXml::StructuralIndex::Detect() == Isa::AVX2){
+        isas.emplace_back("AVX2",Isa::AVX2);
+    }
+#endif
+
+    for(auto &isa : isas){
+        auto name = std::string("StructuralIndex::Build/") + isa.first;
+        Bench::Run(name.c_str(),xml.size(),[&](){
+            Bench::DoNotOptimize(LXml::StructuralIndex::Build(xml,isa.second).element_count());
+        });
+    }
+    Bench::Run("StructuralIndex::count()",xml.size(),[&](){
+        Bench::DoNotOptimize(LXml::StructuralIndex::Build(xml).count("catalog-item-entry"));
+    });
+    Bench::Run("ScanRecords()",xml.size(),[&](){
+        Bench::DoNotOptimize(LXml::ScanRecords(xml,"catalog-item-entry").records.size());
+    });
+}
@@ -0,0 +1,56 @@
+#include "bench.hpp"
+
+//Css selectors against the equivalent translated xpath on a medium html page
+BENCH_GROUP(select) {
+    auto html = Bench::MakeHtml(1000);
+    auto doc  = LXml::HtmlDocument::Parse(html);
+    auto root = doc.root_node();
+
+    struct Case {
+        const char *name;
+        const char *css;
+        const char *xpath;
+    };
+    const Case cases[] = {
+        {"class",".link","descendant::*[contains(concat(' ',normalize-space(@class),' '),' link ')]"},
+        {"child","div.item > a.link",
+            "descendant::div[contains(concat(' ',normalize-space(@class),' '),' item ')]"
+            "/a[contains(concat(' ',normalize-space(@class),' '),' link ')]"},
+        {"descendant","div p b","descendant::div//p//b"},
+        {"id","#item-500","descendant::*[@id = 'item-500']"},
+        {"nth-child","div:nth-child(2n) > a[href^='/item/1']",
+            "descendant::div[(count(preceding-sibling::*) + 1) mod 2 = 0]/a[starts-with(@href,'/item/1')]"},
+    };
+    for(auto &c : cases){
+        std::string name = c.name;
+        Bench::Run(("xpath(" + name + ") all").c_str(),html.size(),[&](){
+            auto obj = root.xpath(c.xpath);
+            Bench::DoNotOptimize(obj.as_nodeset().size());
+        });
+        Bench::Run(("select(" + name + ") all").c_str(),html.size(),[&](){
+            size_t n = 0;
+            for(auto node : root.select(c.css)){
+                n += node.is_element();
+            }
+            Bench::DoNotOptimize(n);
+        });
+        Bench::Run(("xpath(" + name + ") first").c_str(),html.size(),[&](){
+            auto obj = root.xpath(c.xpath);
+            Bench::DoNotOptimize(obj.as_nodeset()[0].get());
+        });
+        Bench::Run(("select_first(" + name + ")").c_str(),html.size(),[&](){
+            Bench::DoNotOptimize(root.select_first(c.css).get());
+        });
+    }
+    auto compiled = LXml::Selector::Compile("div.item > a.link");
+    Bench::Run("select(compiled) all",html.size(),[&](){
+        size_t n = 0;
+        for(auto node : root.select(compiled)){
+            n += node.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("Selector::Compile()",0,[&](){
+        Bench::DoNotOptimize(LXml::Selector::Compile("div.item > a.link[href^='/item/']:nth-child(1)").is_null());
+    });
+}
@@ -0,0 +1,46 @@
+#include "bench.hpp"
+
+//Copying ToString() path against lstring / string_view accessors
+BENCH_GROUP(strings) {
+    auto xml  = Bench::MakeXml(1000);
+    auto doc  = LXml::XmlDocument::Parse(xml);
+    auto root = doc.root_node();
+    auto expr = root.xpath("string(/root/catalog-item-entry[1])");
+
+    Bench::Run("name() copy",0,[&](){
+        for(auto node : root.children()){
+            Bench::DoNotOptimize(LXml::ToString(node.get()->name).size());
+        }
+    });
+    Bench::Run("name_view()",0,[&](){
+        for(auto node : root.children()){
+            Bench::DoNotOptimize(node.name_view().size());
+        }
+    });
+    Bench::Run("content() copy",0,[&](){
+        for(auto node : root.children()){
+            Bench::DoNotOptimize(LXml::ToString(xmlNodeGetContent(node.get())).size());
+        }
+    });
+    Bench::Run("content() lstring",0,[&](){
+        for(auto node : root.children()){
+            Bench::DoNotOptimize(node.content().size());
+        }
+    });
+    Bench::Run("attribute() copy",0,[&](){
+        for(auto node : root.children()){
+            Bench::DoNotOptimize(LXml::ToString(xmlGetProp(node.get(),BAD_CAST "id")).size());
+        }
+    });
+    Bench::Run("attribute() lstring",0,[&](){
+        for(auto node : root.children()){
+            Bench::DoNotOptimize(node.attribute("id").size());
+        }
+    });
+    Bench::Run("as_string() copy",0,[&](){
+        Bench::DoNotOptimize(LXml::ToString(xmlXPathCastToString(expr.get())).size());
+    });
+    Bench::Run("as_string() lstring",0,[&](){
+        Bench::DoNotOptimize(expr.as_string().size());
+    });
+}
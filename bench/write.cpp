@@ -0,0 +1,82 @@
+#include "bench.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+//Exporting rows: DOM + to_string() against the streaming XmlWriter
+BENCH_GROUP(writer) {
+    const size_t rows = 100000;
+    //Output size,for MB/s
+    std::string sample;
+    {
+        LXml::XmlWriter writer{LXml::OutputSink(sample)};
+        writer.start_element("rows");
+        for(size_t i = 0;i < rows;i++){
+            writer.start_element("row");
+            writer.attribute("id",i);
+            writer.attribute("class","entry");
+            writer.text("Text of the row & its value");
+            writer.end_element();
+        }
+        writer.end_document();
+    }
+    auto write_rows = [&](LXml::XmlWriter &writer){
+        writer.start_element("rows");
+        for(size_t i = 0;i < rows;i++){
+            writer.start_element("row");
+            writer.attribute("id",i);
+            writer.attribute("class","entry");
+            writer.text("Text of the row & its value");
+            writer.end_element();
+        }
+        writer.end_document();
+    };
+
+    Bench::Run("Node::New + to_string()",sample.size(),[&](){
+        auto doc = LXml::XmlDocument::New();
+        doc.set_root(LXml::Node::New("rows"));
+        auto root = doc.root_node();
+        for(size_t i = 0;i < rows;i++){
+            auto row = LXml::Node::New("row");
+            row.set_attribute("id",std::to_string(i));
+            row.set_attribute("class","entry");
+            row.set_content("Text of the row &amp; its value");
+            xmlAddChild(root.get(),row.detach());
+        }
+        Bench::DoNotOptimize(doc.to_string(false).size());
+    });
+    Bench::Run("XmlWriter(callback)",sample.size(),[&](){
+        size_t n = 0;
+        LXml::XmlWriter writer(LXml::OutputSink([&](LXml::u8string_view chunk){
+            n += chunk.size();
+            return true;
+        },LXML_WRITER_BUFFER_SIZE));
+        write_rows(writer);
+        Bench::DoNotOptimize(n);
+    });
+    int fd = ::open("/dev/null",O_WRONLY);
+    if(fd >= 0){
+        LXml::XmlWriter writer{LXml::OutputSink(fd)};
+        Bench::Run("XmlWriter(/dev/null)",sample.size(),[&](){
+            writer.reset(LXml::OutputSink(fd));
+            write_rows(writer);
+            Bench::DoNotOptimize(writer.bytes_written());
+        });
+        ::close(fd);
+    }
+
+    //Escaping throughput on long text
+    std::string text(1 << 20,'a');
+    for(size_t i = 0;i < text.size();i += 200){
+        text[i] = '&';
+    }
+    size_t n = 0;
+    LXml::XmlWriter writer(LXml::OutputSink([&](LXml::u8string_view chunk){
+        n += chunk.size();
+        return true;
+    },LXML_WRITER_BUFFER_SIZE));
+    Bench::Run("XmlWriter::text(1MB)",text.size(),[&](){
+        writer.text(text);
+        writer.flush();
+        Bench::DoNotOptimize(n);
+    });
+}
@@ -0,0 +1,110 @@
+#include "bench.hpp"
+
+BENCH_GROUP(xpath) {
+    auto xml  = Bench::MakeXml(10);
+    auto doc  = LXml::XmlDocument::Parse(xml);
+    auto root = doc.root_node();
+    const char *expr = "/root/catalog-item-entry[@id = 'catalog-item-3']/@class";
+
+    Bench::Run("xpath() uncached",0,[&](){
+        xmlXPathContextPtr ctxt = xmlXPathNewContext(doc.get());
+        LXml::XPathObject obj(xmlXPathNodeEval(root.get(),BAD_CAST expr,ctxt));
+        xmlXPathFreeContext(ctxt);
+        Bench::DoNotOptimize(obj.get());
+    });
+    Bench::Run("xpath() cached",0,[&](){
+        Bench::DoNotOptimize(root.xpath(expr).get());
+    });
+    auto compiled = LXml::XPathExpression::Compile(expr);
+    LXml::XPathContent ctxt(doc);
+    Bench::Run("XPathContent::eval(compiled)",0,[&](){
+        Bench::DoNotOptimize(ctxt.eval(root,compiled).get());
+    });
+    Bench::Run("eval(compiled) new context",0,[&](){
+        LXml::XPathContent tmp(doc);
+        Bench::DoNotOptimize(tmp.eval(root,compiled).get());
+    });
+
+    //Queries over a medium document
+    auto big      = Bench::MakeXml(1000);
+    auto big_doc  = LXml::XmlDocument::Parse(big);
+    auto big_root = big_doc.root_node();
+    Bench::Run("xpath(//tag)",0,[&](){
+        Bench::DoNotOptimize(big_root.xpath("//catalog-item-entry").get());
+    });
+    Bench::Run("xpath(//tag[@attr])",0,[&](){
+        Bench::DoNotOptimize(big_root.xpath("//catalog-item-entry[@id = 'catalog-item-500']").get());
+    });
+    Bench::Run("xpath(count())",0,[&](){
+        Bench::DoNotOptimize(big_root.xpath("count(/root/catalog-item-entry)").get());
+    });
+}
+
+//Fixed paths: compile-time PathQuery against the same xpath
+BENCH_GROUP(path) {
+    auto xml  = Bench::MakeXml(1000);
+    auto doc  = LXml::XmlDocument::Parse(xml);
+    auto root = doc.root_node();
+    constexpr auto entries = LXml::Path("root") / "catalog-item-entry";
+
+    Bench::Run("xpath(/root/entry) all",0,[&](){
+        auto obj = root.xpath("/root/catalog-item-entry");
+        Bench::DoNotOptimize(obj.as_nodeset().size());
+    });
+    Bench::Run("PathQuery::all()",0,[&](){
+        size_t n = 0;
+        for(auto node : entries.all(doc)){
+            n += node.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("xpath(/root/entry) first",0,[&](){
+        auto obj = root.xpath("/root/catalog-item-entry");
+        Bench::DoNotOptimize(obj.as_nodeset()[0].get());
+    });
+    Bench::Run("PathQuery::first()",0,[&](){
+        Bench::DoNotOptimize(entries.first(doc).get());
+    });
+    Bench::Run("path<>::all()",0,[&](){
+        size_t n = 0;
+        for(auto node : LXml::path<"root","catalog-item-entry">.all(doc)){
+            n += node.is_element();
+        }
+        Bench::DoNotOptimize(n);
+    });
+    Bench::Run("path<>::first()",0,[&](){
+        Bench::DoNotOptimize(LXml::path<"root","catalog-item-entry">.first(doc).get());
+    });
+}
+
+//First hit on a huge document: hit near the start,near the end and no hit
+BENCH_GROUP(first) {
+    auto xml  = Bench::MakeXml(100000);
+    auto doc  = LXml::XmlDocument::Parse(xml);
+    auto root = doc.root_node();
+
+    struct Case {
+        const char *name;
+        const char *expr;
+    };
+    const Case cases[] = {
+        {"early","//catalog-item-entry[@id='catalog-item-10']"},
+        {"late","//catalog-item-entry[@id='catalog-item-99990']"},
+        {"miss","//catalog-item-entry[@id='none']"},
+        {"child early","/root/catalog-item-entry[@class='entry']"},
+    };
+    for(auto &c : cases){
+        std::string name = c.name;
+        Bench::Run(("xpath()[0] " + name).c_str(),0,[&](){
+            auto obj = root.xpath(c.expr);
+            auto set = obj.as_nodeset();
+            Bench::DoNotOptimize(set.size() == 0 ? nullptr : set[0].get());
+        });
+        Bench::Run(("xpath_first() " + name).c_str(),0,[&](){
+            Bench::DoNotOptimize(root.xpath_first(c.expr).get());
+        });
+        Bench::Run(("xpath_exists() " + name).c_str(),0,[&](){
+            Bench::DoNotOptimize(root.xpath_exists(c.expr));
+        });
+    }
+}
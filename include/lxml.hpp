@@ -1,20 +1,20 @@
 #pragma once
 
-#define LXML_CXX17 (__cplusplus >= 201703L)
-
-#ifndef LXML_U8STRING_VIEW
-    #if !LXML_CXX17
-        #define LXML_U8STRING_VIEW const LXML_U8STRING &
-    #else
-        #define LXML_U8STRING_VIEW std::string_view
-        #include <string_view>
-    #endif
+//The views (u8string_view),if constexpr and the charconv formatting need C++17,
+//the coroutine and template string parts are enabled on C++20
+#if defined(_MSVC_LANG)
+    #define LXML_CPLUSPLUS _MSVC_LANG
+#else
+    #define LXML_CPLUSPLUS __cplusplus
+#endif
+#if LXML_CPLUSPLUS < 201703L
+    #error "lxml.hpp requires C++17"
 #endif
+#define LXML_CXX20 (LXML_CPLUSPLUS >= 202002L)
 
-#if LXML_CXX17
-    #define LXML_CONSTEXPR constexpr
-#else
-    #define LXML_CONSTEXPR const
+#ifndef LXML_U8STRING_VIEW
+    #define LXML_U8STRING_VIEW std::string_view
+    #include <string_view>
 #endif
 
 #ifndef LXML_U8STRING
@@ -44,6 +44,26 @@
         }
 #endif
 
+#ifndef LXML_XPATH_CACHE_SIZE
+    #define LXML_XPATH_CACHE_SIZE 128
+#endif
+
+#ifndef LXML_FILE_CHUNK_SIZE
+    #define LXML_FILE_CHUNK_SIZE (1 << 20)
+#endif
+
+#ifndef LXML_ARENA_BLOCK_SIZE
+    #define LXML_ARENA_BLOCK_SIZE (1 << 20)
+#endif
+
+#ifndef LXML_OUTPUT_CHUNK_SIZE
+    #define LXML_OUTPUT_CHUNK_SIZE 4096
+#endif
+
+#ifndef LXML_WRITER_BUFFER_SIZE
+    #define LXML_WRITER_BUFFER_SIZE (1 << 16)
+#endif
+
 #ifndef LXML_ASSERT
     #define LXML_ASSERT(X) assert(X)
     #include <cassert>
@@ -63,15 +83,63 @@
 #include <libxml/HTMLtree.h>
 #include <libxml/xmlversion.h>
 #include <libxml/xpath.h>
+#include <libxml/xpathInternals.h>
+#include <libxml/parserInternals.h>
+#include <libxml/xmlreader.h>
+#include <libxml/xmlsave.h>
 #include <libxml/tree.h>
 //--Import std headers
 #include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <functional>
+#include <ostream>
+#include <climits>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <initializer_list>
+#include <tuple>
+#include <exception>
+    #include <charconv>
+    #include <optional>
+#if LXML_CXX20
+    #include <coroutine>
+    #include <concepts>
+#endif
+//--Import platform headers
+#if defined(__unix__) || defined(__APPLE__)
+    #define LXML_POSIX 1
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#else
+    #define LXML_POSIX 0
+#endif
+#if !defined(LXML_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+    #define LXML_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(__GNUC__) || defined(__clang__)
+        #define LXML_TARGET_AVX2 __attribute__((target("avx2,bmi")))
+    #else
+        #define LXML_TARGET_AVX2
+    #endif
+#else
+    #define LXML_SIMD_X86 0
+#endif
 
-//--Detail of progress
-//--TODO : Add a special class to manage mem return by libxml2,avoid useless copy
-//         Such as LXml::lstring or LXml::string or LXml::ustring
-//--TODO : Add SAXParser
-//--TODO : Add PushParser
 
 
 
@@ -90,6 +158,29 @@ class XPathContent;
 class XPathObject;
 class Document;
 class Node;
+class Name;
+class ElementIterator;
+class Elements;
+template<class Filter>
+class Descendants;
+class Selector;
+namespace Detail {
+    struct AnyElement;
+}
+using Selection = Descendants<Selector>;
+class FrozenDocument;
+class FrozenNode;
+template<bool ElementsOnly>
+class FrozenChildIterator;
+class FrozenDescendantIterator;
+class FrozenAttributeIterator;
+template<class Iterator>
+class FrozenRange;
+using FrozenChildren = FrozenRange<FrozenChildIterator<false>>;
+using FrozenElements = FrozenRange<FrozenChildIterator<true>>;
+using FrozenDescendants = FrozenRange<FrozenDescendantIterator>;
+using FrozenAttributes = FrozenRange<FrozenAttributeIterator>;
+class lstring;
 //--Common constants
 enum ParseOptions : int {
     NoBlanks = XML_PARSE_NOBLANKS,
@@ -100,7 +191,7 @@ enum ParseOptions : int {
     NoEntities = XML_PARSE_NOENT,
     Recover = XML_PARSE_RECOVER,
 };
-LXML_CONSTEXPR int DefaultOptions = NoBlanks | NoError | NoWarning | NoNetwork | Recover;
+constexpr int DefaultOptions = NoBlanks | NoError | NoWarning | NoNetwork | Recover;
 
 //--LXml String
 inline u8string ToString(xmlChar *s) {
@@ -118,6 +209,237 @@ inline u8string ToString(const xmlChar *s) {
     u8string us(reinterpret_cast<const char_t *>(s));
     return us;
 }
+/**
+ * @brief Borrow a string owned by libxml2,no copy
+ * 
+ * @return u8string_view (empty if s is nullptr)
+ */
+inline u8string_view ToView(const xmlChar *s) noexcept {
+    if(s == nullptr){
+        return u8string_view();
+    }
+    return u8string_view(reinterpret_cast<const char_t *>(s));
+}
+/**
+ * @brief Compare a zero terminated libxml2 string with a view,no strlen
+ * 
+ */
+inline bool NameEquals(const xmlChar *s,u8string_view name) noexcept {
+    return s != nullptr &&
+           std::strncmp(reinterpret_cast<const char *>(s),name.data(),name.size()) == 0 &&
+           s[name.size()] == 0;
+}
+/**
+ * @brief Owning handle of a string allocated by libxml2,it adopts the memory without copy
+ *        and release it by xmlFree
+ * 
+ */
+class lstring {
+    public:
+        using value_type = char_t;
+        using size_type = size_t;
+        using iterator = const char_t *;
+        using const_iterator = const char_t *;
+
+        lstring() = default;
+        lstring(const lstring &other) {
+            if(other.str != nullptr){
+                str = xmlStrndup(other.str,other.len);
+                len = other.len;
+            }
+        }
+        lstring(lstring &&other) noexcept : str(other.str), len(other.len) {
+            other.str = nullptr;
+            other.len = 0;
+        }
+        ~lstring() {
+            if(str != nullptr){
+                xmlFree(str);
+            }
+        }
+        /**
+         * @brief Adopt a string allocated by libxml2
+         * 
+         * @param s The string (could be nullptr)
+         */
+        explicit lstring(xmlChar *s) noexcept : str(s) {
+            if(s != nullptr){
+                len = xmlStrlen(s);
+            }
+        }
+        lstring(xmlChar *s,size_t n) noexcept : str(s), len(n) {}
+
+        lstring &operator =(const lstring &other) {
+            if(this != &other){
+                lstring tmp(other);
+                swap(tmp);
+            }
+            return *this;
+        }
+        lstring &operator =(lstring &&other) noexcept {
+            if(this != &other){
+                lstring tmp(std::move(other));
+                swap(tmp);
+            }
+            return *this;
+        }
+    public:
+        bool is_null() const noexcept {
+            return str == nullptr;
+        }
+        bool empty() const noexcept {
+            return len == 0;
+        }
+        size_t size() const noexcept {
+            return len;
+        }
+        size_t length() const noexcept {
+            return len;
+        }
+        /**
+         * @brief Get the zero terminated string,never nullptr
+         * 
+         * @return const char_t* 
+         */
+        const char_t *data() const noexcept {
+            return str == nullptr ? "" : reinterpret_cast<const char_t *>(str);
+        }
+        const char_t *c_str() const noexcept {
+            return data();
+        }
+        const_iterator begin() const noexcept {
+            return data();
+        }
+        const_iterator end() const noexcept {
+            return data() + len;
+        }
+        char_t operator [](size_t i) const noexcept {
+            return data()[i];
+        }
+        //--Convert
+        u8string_view view() const noexcept {
+            return u8string_view(data(),len);
+        }
+        u8string to_string() const {
+            return u8string(data(),len);
+        }
+        operator u8string_view() const noexcept {
+            return view();
+        }
+        operator u8string() const {
+            return to_string();
+        }
+        //--Ownership
+        xmlChar *get() const noexcept {
+            return str;
+        }
+        /**
+         * @brief Release the ownership,caller should free it by xmlFree
+         * 
+         * @return xmlChar* 
+         */
+        xmlChar *release() noexcept {
+            auto s = str;
+            str = nullptr;
+            len = 0;
+            return s;
+        }
+        void reset(xmlChar *s = nullptr) noexcept {
+            if(str != nullptr){
+                xmlFree(str);
+            }
+            str = s;
+            len = (s == nullptr) ? 0 : xmlStrlen(s);
+        }
+        void swap(lstring &other) noexcept {
+            std::swap(str,other.str);
+            std::swap(len,other.len);
+        }
+        //--Compare
+        friend bool operator ==(const lstring &a,const lstring &b) noexcept {
+            return a.view() == b.view();
+        }
+        friend bool operator !=(const lstring &a,const lstring &b) noexcept {
+            return a.view() != b.view();
+        }
+        friend bool operator ==(const lstring &a,u8string_view b) noexcept {
+            return a.view() == b;
+        }
+        friend bool operator !=(const lstring &a,u8string_view b) noexcept {
+            return a.view() != b;
+        }
+        friend bool operator ==(u8string_view a,const lstring &b) noexcept {
+            return a == b.view();
+        }
+        friend bool operator !=(u8string_view a,const lstring &b) noexcept {
+            return a != b.view();
+        }
+        //--Output to any std::ostream like
+        template<class Stream>
+        friend auto operator <<(Stream &os,const lstring &s) -> decltype(os << u8string_view()) {
+            return os << s.view();
+        }
+    private:
+        xmlChar *str = nullptr;
+        size_t   len = 0;
+};
+/**
+ * @brief Destination of the serialization,a file descriptor,a std::ostream,a string or a callback
+ * 
+ */
+class OutputSink {
+    public:
+        /**
+         * @brief Receive a chunk of output
+         * 
+         * @return false to abort the serialization
+         */
+        using Callback = std::function<bool(u8string_view chunk)>;
+
+        explicit OutputSink(int fd) : fd(fd) {}
+        OutputSink(std::ostream &os) : stream(&os) {}
+        OutputSink(u8string &str) : string(&str) {}
+        /**
+         * @brief Send the output by chunks,every chunk but the last one has exactly chunk_size bytes
+         * 
+         * @note A chunk_size of 0 is taken as 1
+         */
+        OutputSink(Callback cb,size_t chunk_size = LXML_OUTPUT_CHUNK_SIZE) :
+            callback(std::move(cb)), chunk(chunk_size == 0 ? 1 : chunk_size) {
+            buffer.reserve(chunk);
+        }
+        OutputSink(const OutputSink &) = delete;
+        OutputSink(OutputSink &&) = default;
+        ~OutputSink() = default;
+
+        OutputSink &operator =(OutputSink &&) = default;
+
+        bool write(const char *data,size_t n);
+        /**
+         * @brief Send the pending data of a callback sink
+         * 
+         */
+        bool flush();
+        /**
+         * @brief Open a libxml2 save context writing to the sink,free it by xmlSaveClose
+         * 
+         */
+        xmlSaveCtxtPtr open_save(int options);
+    private:
+        static int WriteCallback(void *ctx,const char *data,int n) {
+            return static_cast<OutputSink*>(ctx)->write(data,n) ? n : -1;
+        }
+        static int CloseCallback(void *ctx) {
+            return static_cast<OutputSink*>(ctx)->flush() ? 0 : -1;
+        }
+
+        int           fd = -1;
+        std::ostream *stream = nullptr;
+        u8string     *string = nullptr;
+        Callback      callback;
+        size_t        chunk = 0;
+        u8string      buffer;
+};
 /**
  * @brief Reference to a document
  * 
@@ -142,6 +464,16 @@ class DocumentRef {
          */
         NodeRef root_node() const;
         Document    clone() const;
+        /**
+         * @brief Find the name in the document's dict,for pointer comparison
+         * 
+         */
+        Name    intern(u8string_view s) const;
+        /**
+         * @brief Take a flat read only snapshot of the document,for fast repeated traversals
+         * 
+         */
+        FrozenDocument freeze() const;
         /**
          * @brief Set the root object
          * 
@@ -150,13 +482,16 @@ class DocumentRef {
         Node    set_root(Node &&);
 
         u8string to_string(bool format = true) const {
-            xmlChar *text;
-            int      size;
-            xmlDocDumpFormatMemory(doc,&text,&size,format);
-            u8string us(reinterpret_cast<char_t *>(text),size);
-            xmlFree(text);
+            u8string us;
+            write_to(us,format);
             return us;
         }
+        /**
+         * @brief Serialize the document to the sink,the output is streamed with constant memory
+         * 
+         * @return true on success
+         */
+        bool write_to(OutputSink sink,bool format = true) const;
         u8string version() const {
             return (const char_t*)doc->version;
         }
@@ -176,18 +511,99 @@ class Document : public DocumentRef {
     public:
         Document() = default;
         Document(const Document &) = delete;
-        Document(Document &&);
+        Document(Document && d) {
+            doc = d.doc;
+            d.doc = nullptr;
+        }
         ~Document(){
             xmlFreeDoc(doc);
         }
 
         explicit Document(xmlDocPtr p) : DocumentRef(p) {}
 
-        void      assign(Document &&);
-        xmlDocPtr detach() noexcept;
+        void      assign(Document &&d) {
+            xmlFreeDoc(doc);
+            doc = d.doc;
+            d.doc = nullptr;
+        }
+        /**
+         * @brief Release the ownship
+         * 
+         * @return xmlDocPtr 
+         */
+        xmlDocPtr detach() noexcept {
+            auto d = doc;
+            doc = nullptr;
+            return d;
+        }
+
+        Document &operator =(Document &&d) {
+            if(this != &d){
+                assign(std::move(d));
+            }
+            return *this;
+        }
 };
 
 
+/**
+ * @brief Interned name of a document,compare the node name by pointer
+ * 
+ * @note It is valid as long as the document,it matches the nodes whose name is in the document's dict
+ *       (all the parsed nodes,unless NODICT was used).
+ *       The lookup doesn't add the name to the dict,if the name isn't there
+ *       or the document has no dict,it falls back to compare the string
+ */
+class Name {
+    public:
+        Name() = default;
+        Name(const Name &) = default;
+        ~Name() = default;
+        /**
+         * @brief Resolve the name in the document's dict
+         * 
+         * @param s The name,it must outlive the Name if it isn't interned
+         */
+        Name(DocumentRef doc,u8string_view s) : text(s) {
+            xmlDocPtr d = doc.get();
+            if(d != nullptr && d->dict != nullptr){
+                interned = xmlDictExists(d->dict,BAD_CAST s.data(),s.size());
+            }
+            if(interned != nullptr){
+                text = u8string_view(reinterpret_cast<const char*>(interned),s.size());
+            }
+        }
+
+        Name &operator =(const Name &) = default;
+
+        /**
+         * @brief Check the name of xmlNode
+         * 
+         */
+        bool match(const xmlChar *name) const noexcept {
+            if(interned != nullptr){
+                return name == interned;
+            }
+            return NameEquals(name,text);
+        }
+        bool is_interned() const noexcept {
+            return interned != nullptr;
+        }
+        /**
+         * @brief Get the name,the string of the dict once it is interned
+         * 
+         */
+        u8string_view view() const noexcept {
+            return text;
+        }
+        const xmlChar *get() const noexcept {
+            return interned;
+        }
+    private:
+        const xmlChar *interned = nullptr;
+        u8string_view  text;
+};
+
 //--DomNode & Helper
 class NodeChildIterator {
     public:
@@ -255,9 +671,153 @@ class NodeChildren {
         xmlNode *first = nullptr;
         xmlNode *last = nullptr;
 };
-// class NodeAttributes {
-    
-// };
+/**
+ * @brief Iterator over the child elements with the given name
+ * 
+ */
+class NamedChildIterator {
+    public:
+        NamedChildIterator() = default;
+        NamedChildIterator(xmlNode *cur,const Name &name) : cur(cur), name(name) {
+            skip();
+        }
+
+        bool operator ==(const NamedChildIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const NamedChildIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        NamedChildIterator &operator ++() noexcept {
+            cur = cur->next;
+            skip();
+            return *this;
+        }
+        NamedChildIterator operator ++(int) noexcept {
+            NamedChildIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        NodeRef operator  *() const noexcept;
+        NodeRef operator ->() const noexcept;
+    private:
+        void skip() noexcept {
+            while(cur != nullptr && !(cur->type == XML_ELEMENT_NODE && name.match(cur->name))){
+                cur = cur->next;
+            }
+        }
+        xmlNode *cur = nullptr;
+        Name     name;
+};
+class NamedChildren {
+    public:
+        using iterator = NamedChildIterator;
+        using const_iterator = NamedChildIterator;
+        using value_type = NodeRef;
+
+        NamedChildren(xmlNode *first,const Name &name) : first(first), name(name) {}
+
+        iterator begin() const {
+            return iterator(first,name);
+        }
+        iterator end() const {
+            return iterator();
+        }
+    private:
+        xmlNode *first = nullptr;
+        Name     name;
+};
+/**
+ * @brief Attribute of a DomNode,the views point into the node
+ * 
+ */
+struct NodeAttribute {
+    u8string_view name;
+    u8string_view value;
+    xmlAttr      *attr;
+};
+/**
+ * @brief Borrow the value of the attribute,it works if the value is a single text node
+ * 
+ * @return true if the value could be borrowed (no entity references in it)
+ */
+inline bool AttributeView(const xmlAttr *attr,u8string_view &value) noexcept {
+    const xmlNode *child = attr->children;
+    if(child == nullptr){
+        value = u8string_view();
+        return true;
+    }
+    if(child->next == nullptr && child->type == XML_TEXT_NODE){
+        value = ToView(child->content);
+        return true;
+    }
+    return false;
+}
+class NodeAttributeIterator {
+    public:
+        NodeAttributeIterator() = default;
+        NodeAttributeIterator(xmlAttr *cur) : cur(cur) {}
+        NodeAttributeIterator(const NodeAttributeIterator &iter) : cur(iter.cur) {}
+        ~NodeAttributeIterator() = default;
+
+        NodeAttributeIterator &operator =(const NodeAttributeIterator &iter) {
+            cur = iter.cur;
+            return *this;
+        }
+        //Compare
+        bool operator ==(const NodeAttributeIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const NodeAttributeIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        //Move
+        NodeAttributeIterator &operator ++() noexcept {
+            cur = cur->next;
+            return *this;
+        }
+        NodeAttributeIterator operator ++(int) noexcept {
+            NodeAttributeIterator tmp(*this);
+            cur = cur->next;
+            return tmp;
+        }
+        /**
+         * @brief Get the attribute
+         * 
+         * @note The value is copied only if it has entity references,it keeps valid until the iterator moves
+         */
+        NodeAttribute operator *() const {
+            u8string_view value;
+            if(!AttributeView(cur,value)){
+                scratch.reset(xmlNodeListGetString(cur->doc,cur->children,1));
+                value = scratch.view();
+            }
+            return NodeAttribute{ToView(cur->name),value,cur};
+        }
+    private:
+        xmlAttr *cur = nullptr;
+        mutable lstring scratch;
+};
+class NodeAttributes {
+    public:
+        using iterator = NodeAttributeIterator;
+        using const_iterator = NodeAttributeIterator;
+        using value_type = NodeAttribute;
+
+        NodeAttributes(xmlAttr *first) : first(first) {}
+
+        iterator begin() const {
+            return iterator(first);
+        }
+        iterator end() const {
+            return iterator(nullptr);
+        }
+        bool empty() const noexcept {
+            return first == nullptr;
+        }
+    private:
+        xmlAttr *first = nullptr;
+};
 
 /**
  * @brief The reference to a DomNode
@@ -310,12 +870,32 @@ class NodeRef {
         bool is_blank() const {
             return xmlIsBlankNode(node) == 1;
         }
+        /**
+         * @brief Check it is a element with the name,compared by pointer
+         * 
+         */
+        bool is(const Name &name) const noexcept {
+            return node->type == XML_ELEMENT_NODE && name.match(node->name);
+        }
         //--Content
         u8string value() const {
             return ToString(static_cast<const xmlChar *>(node->content));
         }
-        u8string content() const {
-            return ToString(xmlNodeGetContent(node));
+        /**
+         * @brief Borrow the node->content,no copy
+         * 
+         * @note The view is invalid after the node was modified or freed
+         */
+        u8string_view value_view() const noexcept {
+            return ToView(node->content);
+        }
+        /**
+         * @brief Get the content of the node and its children
+         * 
+         * @return lstring (adopt the memory from libxml2,no copy)
+         */
+        lstring content() const {
+            return lstring(xmlNodeGetContent(node));
         }
         void set_content(u8string_view s) {
             xmlNodeSetContentLen(node,BAD_CAST s.data(),s.size());
@@ -327,13 +907,67 @@ class NodeRef {
         u8string name() const {
             return ToString(node->name);
         }
+        /**
+         * @brief Borrow the node->name,no copy
+         * 
+         */
+        u8string_view name_view() const noexcept {
+            return ToView(node->name);
+        }
         void set_name(u8string_view s) {
             xmlNodeSetName(node,BAD_CAST s.data());
         }
         //--Attributes
-        u8string attribute(u8string_view name) const {
-            return ToString(xmlGetProp(node,BAD_CAST name.data()));
-        }
+        lstring attribute(u8string_view name) const {
+            if(auto attr = find_attribute(name)){
+                return lstring(xmlNodeListGetString(node->doc,attr->children,1));
+            }
+            if(HasAttributeDecls(node->doc)){
+                //Let libxml2 check the default value in DTD
+                u8string n(name);
+                return lstring(xmlGetProp(node,BAD_CAST n.c_str()));
+            }
+            return lstring();
+        }
+        /**
+         * @brief Borrow the value of the attribute,no allocation
+         * 
+         * @note Empty if missing or the value has entity references (use attribute() then),
+         *       DTD default values are not considered
+         */
+        u8string_view attribute_view(u8string_view name) const noexcept {
+            u8string_view value;
+            if(auto attr = find_attribute(name)){
+                AttributeView(attr,value);
+            }
+            return value;
+        }
+        /**
+         * @brief Check the attribute is set on the node,DTD default values are not considered
+         * 
+         */
+        bool has_attribute(u8string_view name) const noexcept {
+            return find_attribute(name) != nullptr;
+        }
+        NodeAttributes attributes() const noexcept {
+            return NodeAttributes(node->type == XML_ELEMENT_NODE ? node->properties : nullptr);
+        }
+        /**
+         * @brief Find the attribute by local name,no matter its namespace
+         * 
+         * @return xmlAttr* (nullptr on not found)
+         */
+        xmlAttr *find_attribute(u8string_view name) const noexcept {
+            if(node->type != XML_ELEMENT_NODE){
+                return nullptr;
+            }
+            for(xmlAttr *attr = node->properties;attr != nullptr;attr = attr->next){
+                if(NameEquals(attr->name,name)){
+                    return attr;
+                }
+            }
+            return nullptr;
+        }
         void set_attribute(u8string_view name,u8string_view value) {
             xmlSetProp(node,BAD_CAST name.data(),BAD_CAST value.data());
         }
@@ -348,6 +982,29 @@ class NodeRef {
         NodeChildren children() const {
             return NodeChildren(node->children,node->last);
         }
+        /**
+         * @brief Get the child elements with the name,compared by pointer
+         * 
+         */
+        NamedChildren children_named(const Name &name) const {
+            return NamedChildren(node->children,name);
+        }
+        /**
+         * @brief Get the child elements,text / comment / blank nodes are skipped
+         * 
+         */
+        Elements elements() const noexcept;
+        /**
+         * @brief Get all the descendant elements in document order,lazily walked
+         * 
+         */
+        Descendants<Detail::AnyElement> descendants() const noexcept;
+        /**
+         * @brief Get the descendant elements which filter(NodeRef) returns true
+         * 
+         */
+        template<class Filter>
+        Descendants<Filter> descendants(Filter filter) const;
         NodeRef first_child() const {
             return NodeRef(node->children);
         }
@@ -368,13 +1025,60 @@ class NodeRef {
         xmlNodePtr get() const noexcept {
             return node;
         }
+        //--Serialize
+        u8string to_string(bool format = true) const {
+            u8string us;
+            write_to(us,format);
+            return us;
+        }
+        /**
+         * @brief Serialize the node and its children to the sink
+         * 
+         * @return true on success
+         */
+        bool write_to(OutputSink sink,bool format = true) const;
+        //--Find Node by css selector
+        /**
+         * @brief Get the descendant elements matching the css selector,lazily walked
+         * 
+         * @param css The selector,compiled once and cached (empty range on syntax error)
+         */
+        Selection select(u8string_view css) const;
+        Selection select(const Selector &selector) const;
+        /**
+         * @brief Get the first descendant element matching the css selector
+         * 
+         * @return NodeRef (null on none)
+         */
+        NodeRef   select_first(u8string_view css) const;
+        NodeRef   select_first(const Selector &selector) const;
+        bool      matches(const Selector &selector) const;
         //--Find Node
         XPathObject xpath(u8string_view s) const;
+        /**
+         * @brief Get the first node of the xpath result in document order,it stops at the first hit
+         *        for the simple paths (child / descendant steps,name tests,[@attr='value'],[n])
+         * 
+         * @return NodeRef (null on none or not a node-set)
+         */
+        NodeRef     xpath_first(u8string_view s) const;
+        /**
+         * @brief Check the xpath result is not empty (boolean() of it),it stops at the first hit like xpath_first
+         * 
+         */
+        bool        xpath_exists(u8string_view s) const;
         //--Create element as child
-        NodeRef create_element(u8string_view name) const;        
+        NodeRef create_element(u8string_view name) const;
 
         Node clone() const;
     private:
+        static bool HasAttributeDecls(xmlDocPtr doc) noexcept {
+            return doc != nullptr && (
+                (doc->intSubset != nullptr && doc->intSubset->attributes != nullptr) ||
+                (doc->extSubset != nullptr && doc->extSubset->attributes != nullptr)
+            );
+        }
+
         xmlNodePtr node = nullptr;
     friend class Node;
 };
@@ -432,6 +1136,8 @@ class XmlDocument : public Document {
         using Document::Document;
         //--Parse a document from a string
         static XmlDocument Parse(u8string_view str,int opt = DefaultOptions);
+        //--Parse a document from a file,it is mapped into memory instead of being copied
+        static XmlDocument ParseFile(const char *path,int opt = DefaultOptions);
         static XmlDocument New(const char *version = "1.0");
 };
 
@@ -440,23 +1146,346 @@ class HtmlDocument : public Document {
         using Document::Document;
         //--Parse a document from a string
         static HtmlDocument Parse(u8string_view str,int opt = DefaultOptions);
+        //--Parse a document from a file,it is mapped into memory instead of being copied
+        static HtmlDocument ParseFile(const char *path,int opt = DefaultOptions);
         static HtmlDocument New(const char *url = nullptr,const char *ext_id = nullptr);
 };
 
+//--Traversal
+namespace Detail {
+    struct AnyElement {
+        bool operator ()(const NodeRef &) const noexcept {
+            return true;
+        }
+    };
+    /**
+     * @brief Next node of the pre-order walk in the subtree of root,without a stack
+     * 
+     * @return nullptr on the end of the subtree
+     */
+    inline xmlNode *NextInTree(xmlNode *cur,const xmlNode *root) noexcept {
+        //Only descend into elements,the children of entity refs are the shared entity content
+        if(cur->type == XML_ELEMENT_NODE && cur->children != nullptr){
+            return cur->children;
+        }
+        while(cur != root){
+            if(cur->next != nullptr){
+                return cur->next;
+            }
+            cur = cur->parent;
+        }
+        return nullptr;
+    }
+    inline xmlNode *NextElement(xmlNode *cur) noexcept {
+        while(cur != nullptr && cur->type != XML_ELEMENT_NODE){
+            cur = cur->next;
+        }
+        return cur;
+    }
+}
+/**
+ * @brief Iterator over the child elements
+ * 
+ */
+class ElementIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = NodeRef;
+        using difference_type = std::ptrdiff_t;
+        using pointer = NodeRef;
+        using reference = NodeRef;
+
+        ElementIterator() = default;
+        ElementIterator(xmlNode *cur) : cur(Detail::NextElement(cur)) {}
+
+        bool operator ==(const ElementIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const ElementIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        ElementIterator &operator ++() noexcept {
+            cur = Detail::NextElement(cur->next);
+            return *this;
+        }
+        ElementIterator operator ++(int) noexcept {
+            ElementIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        NodeRef operator  *() const noexcept {
+            return NodeRef(cur);
+        }
+        NodeRef operator ->() const noexcept {
+            return NodeRef(cur);
+        }
+    private:
+        xmlNode *cur = nullptr;
+};
+class Elements {
+    public:
+        using iterator = ElementIterator;
+        using const_iterator = ElementIterator;
+        using value_type = NodeRef;
+
+        Elements(xmlNode *head) : head(head) {}
+
+        iterator begin() const noexcept {
+            return iterator(head);
+        }
+        iterator end() const noexcept {
+            return iterator();
+        }
+        /**
+         * @brief Get the first element,null on empty
+         * 
+         */
+        NodeRef first() const noexcept {
+            return *begin();
+        }
+        bool empty() const noexcept {
+            return begin() == end();
+        }
+    private:
+        xmlNode *head = nullptr;
+};
+/**
+ * @brief Pre-order iterator over the descendant elements,it only holds the current node
+ * 
+ */
+template<class Filter>
+class DescendantIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = NodeRef;
+        using difference_type = std::ptrdiff_t;
+        using pointer = NodeRef;
+        using reference = NodeRef;
+
+        DescendantIterator() = default;
+        DescendantIterator(xmlNode *root,const Filter *filter) : root(root), filter(filter) {
+            cur = root != nullptr ? root->children : nullptr;
+            skip();
+        }
+
+        bool operator ==(const DescendantIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const DescendantIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        DescendantIterator &operator ++() {
+            cur = Detail::NextInTree(cur,root);
+            skip();
+            return *this;
+        }
+        DescendantIterator operator ++(int) {
+            DescendantIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        /**
+         * @brief Don't walk into the children of the current element
+         * 
+         */
+        DescendantIterator &skip_children() {
+            while(cur != root && cur->next == nullptr){
+                cur = cur->parent;
+            }
+            cur = cur == root ? nullptr : cur->next;
+            skip();
+            return *this;
+        }
+        NodeRef operator  *() const noexcept {
+            return NodeRef(cur);
+        }
+        NodeRef operator ->() const noexcept {
+            return NodeRef(cur);
+        }
+    private:
+        void skip() {
+            while(cur != nullptr && !(cur->type == XML_ELEMENT_NODE && (*filter)(NodeRef(cur)))){
+                cur = Detail::NextInTree(cur,root);
+            }
+        }
+        xmlNode      *root = nullptr;
+        xmlNode      *cur = nullptr;
+        const Filter *filter = nullptr;
+};
+/**
+ * @brief Lazy range of the descendant elements,the filter is stored in the range
+ * 
+ * @note The iterators refer to the range,keep it alive while iterating
+ */
+template<class Filter>
+class Descendants {
+    public:
+        using iterator = DescendantIterator<Filter>;
+        using const_iterator = DescendantIterator<Filter>;
+        using value_type = NodeRef;
+
+        Descendants(xmlNode *root,Filter filter) : root(root), filter(std::move(filter)) {}
+
+        iterator begin() const {
+            return iterator(root,&filter);
+        }
+        iterator end() const {
+            return iterator();
+        }
+        /**
+         * @brief Get the first match,null on none,the walk stops on it
+         * 
+         */
+        NodeRef first() const {
+            return *begin();
+        }
+        bool empty() const {
+            return begin() == end();
+        }
+    private:
+        xmlNode *root;
+        Filter   filter;
+};
+
 //--Impl Node & Helper
+inline Elements NodeRef::elements() const noexcept {
+    return Elements(node->children);
+}
+inline Descendants<Detail::AnyElement> NodeRef::descendants() const noexcept {
+    return Descendants<Detail::AnyElement>(node,Detail::AnyElement());
+}
+template<class Filter>
+inline Descendants<Filter> NodeRef::descendants(Filter filter) const {
+    return Descendants<Filter>(node,std::move(filter));
+}
 inline NodeRef NodeChildIterator::operator *() const noexcept {
     return NodeRef(cur);
 }
 inline NodeRef NodeChildIterator::operator ->() const noexcept {
     return NodeRef(cur);
 } 
+inline NodeRef NamedChildIterator::operator *() const noexcept {
+    return NodeRef(cur);
+}
+inline NodeRef NamedChildIterator::operator ->() const noexcept {
+    return NodeRef(cur);
+}
 //--Impl Doc
 inline NodeRef DocumentRef::root_node() const {
     return NodeRef(xmlDocGetRootElement(doc));
 }
+inline Name DocumentRef::intern(u8string_view s) const {
+    return Name(*this,s);
+}
 inline Node DocumentRef::set_root(Node &&n){
     return Node(xmlDocSetRootElement(doc,n.detach()));
 }
+inline NodeRef NodeRef::create_element(u8string_view name) const {
+    //Same as xmlNewChild,but the name is a view: interned if the document has a dict
+    xmlDocPtr doc = node->doc;
+    xmlChar  *n;
+    if(doc != nullptr && doc->dict != nullptr){
+        n = const_cast<xmlChar*>(xmlDictLookup(doc->dict,BAD_CAST name.data(),int(name.size())));
+    }
+    else{
+        n = xmlStrndup(BAD_CAST name.data(),int(name.size()));
+    }
+    if(n == nullptr){
+        return NodeRef();
+    }
+    //xmlDoc has no ns field,the children of the document node get none
+    bool       is_doc = node->type == XML_DOCUMENT_NODE || node->type == XML_HTML_DOCUMENT_NODE;
+    xmlNodePtr child = xmlNewDocNodeEatName(doc,is_doc ? nullptr : node->ns,n,nullptr);
+    if(child == nullptr){
+        return NodeRef();
+    }
+    return NodeRef(xmlAddChild(node,child));
+}
+//--Impl Output
+inline bool OutputSink::write(const char *data,size_t n) {
+    if(string != nullptr){
+        string->append(data,n);
+        return true;
+    }
+    if(stream != nullptr){
+        stream->write(data,n);
+        return stream->good();
+    }
+    if(callback){
+        //Whole chunks go straight to the callback
+        while(buffer.empty() && n >= chunk){
+            if(!callback(u8string_view(data,chunk))){
+                return false;
+            }
+            data += chunk;
+            n -= chunk;
+        }
+        while(n > 0){
+            size_t len = chunk - buffer.size();
+            if(len > n){
+                len = n;
+            }
+            buffer.append(data,len);
+            data += len;
+            n -= len;
+            if(buffer.size() == chunk){
+                if(!callback(u8string_view(buffer))){
+                    return false;
+                }
+                buffer.clear();
+            }
+        }
+        return true;
+    }
+#if LXML_POSIX
+    while(n > 0){
+        ssize_t ret = ::write(fd,data,n);
+        if(ret < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return false;
+        }
+        data += ret;
+        n -= ret;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+inline bool OutputSink::flush() {
+    if(stream != nullptr){
+        stream->flush();
+        return stream->good();
+    }
+    if(callback && !buffer.empty()){
+        bool ok = callback(u8string_view(buffer));
+        buffer.clear();
+        return ok;
+    }
+    return true;
+}
+inline xmlSaveCtxtPtr OutputSink::open_save(int options) {
+    return xmlSaveToIO(WriteCallback,CloseCallback,this,nullptr,options);
+}
+inline bool DocumentRef::write_to(OutputSink sink,bool format) const {
+    //Same as xmlDocDumpFormatMemory,HTML documents are written as XML
+    xmlSaveCtxtPtr ctxt = sink.open_save((format ? XML_SAVE_FORMAT : 0) | XML_SAVE_AS_XML);
+    if(ctxt == nullptr){
+        return false;
+    }
+    bool ok = xmlSaveDoc(ctxt,doc) >= 0;
+    return xmlSaveClose(ctxt) >= 0 && ok;
+}
+inline bool NodeRef::write_to(OutputSink sink,bool format) const {
+    xmlSaveCtxtPtr ctxt = sink.open_save((format ? XML_SAVE_FORMAT : 0) | XML_SAVE_AS_XML);
+    if(ctxt == nullptr){
+        return false;
+    }
+    bool ok = xmlSaveTree(ctxt,node) >= 0;
+    return xmlSaveClose(ctxt) >= 0 && ok;
+}
 
 inline XmlDocument XmlDocument::Parse(u8string_view str,int opt) {
     xmlDocPtr doc = xmlReadMemory(str.data(),str.size(),"","UTF-8",opt);
@@ -483,27 +1512,58 @@ inline HtmlDocument HtmlDocument::New(const char *url,const char *ext_id) {
     return HtmlDocument(htmlNewDoc(BAD_CAST url,BAD_CAST ext_id));
 }
 //--Init / Quit
+/**
+ * @brief Init the libxml2,call it on the main thread before using libxml2 in other threads
+ * 
+ */
 inline void Init() {
-    xmlInitGlobals();
-}
-inline void Quit() {
-    xmlCleanupParser();
-    xmlCleanupGlobals();
-    xmlDictCleanup();
+    xmlInitParser();
 }
+/**
+ * @brief Cleanup the libxml2,no thread may use libxml2 at the time
+ * 
+ * @note The xpath context of the calling thread is freed first,
+ *       the ones of other threads are freed when they exit,join them before
+ */
+inline void Quit();
+/**
+ * @brief Scoped Init / Quit,it is reference counted
+ * 
+ * @note Threading model:
+ *  The first Library inits libxml2,the last one destroyed cleans it up.
+ *  Create one on the main thread before starting workers,and destroy it after they joined.
+ *  Documents,nodes and readers could be used by only one thread at a time,
+ *  different documents could be parsed and used in parallel.
+ *  GetError() returns the last error of the calling thread.
+ */
 class Library {
     public:
         Library() {
-            Init();
+            std::lock_guard<std::mutex> locker(Mutex());
+            if(RefCount()++ == 0){
+                Init();
+            }
         }
         Library(const Library &) = delete;
         ~Library() {
-            Quit();
+            std::lock_guard<std::mutex> locker(Mutex());
+            if(--RefCount() == 0){
+                Quit();
+            }
+        }
+    private:
+        static std::mutex &Mutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+        static size_t &RefCount() {
+            static size_t count = 0;
+            return count;
         }
 };
 
 /**
- * @brief Get the Error String
+ * @brief Get the Error String of current thread
  * 
  * @return u8string 
  */
@@ -512,7 +1572,7 @@ inline u8string GetError() {
     if(err == nullptr){
         return u8string();
     }
-    return u8string(reinterpret_cast<const char_t *>(err->message));
+    return ToString(reinterpret_cast<const xmlChar *>(err->message));
 }
 LXML_NS_END
 
@@ -664,9 +1724,9 @@ class XPathObject {
             LXML_CHECK(is_number());
             return xmlXPathCastToNumber(obj);
         }
-        u8string     as_string() const {
+        lstring      as_string() const {
             LXML_CHECK(is_string());
-            return (char_t*)xmlXPathCastToString(obj);
+            return lstring(xmlXPathCastToString(obj));
         }
         XPathNodeSet as_nodeset() const {
             LXML_CHECK(is_nodeset());
@@ -684,12 +1744,16 @@ class XPathObject {
             }
             return XPathIterator(set,set->nodeNr);
         }
+
+        xmlXPathObjectPtr get() const noexcept {
+            return obj;
+        }
     private:
         xmlXPathObjectPtr obj = nullptr;
 };
 class XPathContent {
     public:
-        XPathContent();
+        XPathContent() = default;
         XPathContent(DocumentRef doc) {
             ctxt = xmlXPathNewContext(doc.get());
         }
@@ -702,7 +1766,7 @@ class XPathContent {
             xmlXPathFreeContext(ctxt);
         }
 
-        XPathExpression compile(u8string_view s);
+        XPathExpression compile(u8string_view s) const;
         /**
          * @brief Eval on the current context
          * 
@@ -717,7 +1781,7 @@ class XPathContent {
                 )
             );
         }
-        // XPathObject eval(const XPathExpression &) const;
+        XPathObject eval(const XPathExpression &) const;
         /**
          * @brief Eval on node you gived,not on the root node of the document
          * 
@@ -733,7 +1797,74 @@ class XPathContent {
                 )
             );
         }
-        // XPathObject eval(NodeRef node,const XPathExpression &) const;
+        XPathObject eval(NodeRef node,const XPathExpression &) const;
+
+        /**
+         * @brief Register a namespace prefix,it keeps alive until the context is freed or reset
+         * 
+         * @return true on success
+         */
+        bool register_namespace(u8string_view prefix,u8string_view uri) {
+            u8string p(prefix);
+            u8string u(uri);
+            return xmlXPathRegisterNs(ctxt,BAD_CAST p.c_str(),BAD_CAST u.c_str()) == 0;
+        }
+        bool register_variable(u8string_view name,double value) {
+            return register_variable(name,xmlXPathNewFloat(value));
+        }
+        bool register_variable(u8string_view name,bool value) {
+            return register_variable(name,xmlXPathNewBoolean(value));
+        }
+        /**
+         * @brief Register a number,it makes register_variable(name,1) pick neither double nor bool
+         * 
+         */
+        template<class V,class = std::enable_if_t<std::is_integral<V>::value && !std::is_same<V,bool>::value>>
+        bool register_variable(u8string_view name,V value) {
+            return register_variable(name,xmlXPathNewFloat(double(value)));
+        }
+        bool register_variable(u8string_view name,u8string_view value) {
+            u8string v(value);
+            return register_variable(name,xmlXPathNewString(BAD_CAST v.c_str()));
+        }
+        bool register_variable(u8string_view name,const char_t *value) {
+            return register_variable(name,xmlXPathNewString(BAD_CAST value));
+        }
+        bool register_variable(u8string_view name,NodeRef value) {
+            return register_variable(name,xmlXPathNewNodeSet(value.get()));
+        }
+        /**
+         * @brief Register a variable,the context takes the ownership of the object
+         * 
+         * @return true on success
+         */
+        bool register_variable(u8string_view name,xmlXPathObjectPtr value) {
+            u8string n(name);
+            return xmlXPathRegisterVariable(ctxt,BAD_CAST n.c_str(),value) == 0;
+        }
+        void clear_namespaces() {
+            xmlXPathRegisteredNsCleanup(ctxt);
+        }
+        void clear_variables() {
+            xmlXPathRegisteredVariablesCleanup(ctxt);
+        }
+        /**
+         * @brief Rebind the context to another document,the registered namespaces and variables are cleared
+         *        (a node set variable would point into the old document)
+         * 
+         */
+        void reset(DocumentRef doc) noexcept {
+            clear_namespaces();
+            clear_variables();
+            ctxt->doc = doc.get();
+            ctxt->node = nullptr;
+            ctxt->contextSize = -1;
+            ctxt->proximityPosition = -1;
+        }
+
+        xmlXPathContextPtr get() const noexcept {
+            return ctxt;
+        }
 
         //Assign
         void assign(XPathContent &&other){
@@ -750,7 +1881,36 @@ class XPathContent {
             return *this;
         }
     private:
+        /**
+         * @brief Get the context of current thread,bound to doc for one NodeRef::xpath call
+         * 
+         * It is private,a kept reference would be rebound by the next call
+         */
+        static XPathContent &Local(DocumentRef doc) {
+            auto &local = LocalSlot();
+            if(local.ctxt == nullptr){
+                local.ctxt = xmlXPathNewContext(nullptr);
+            }
+            local.reset(doc);
+            return local;
+        }
+        static XPathContent &LocalSlot() {
+            thread_local XPathContent local;
+            return local;
+        }
+        /**
+         * @brief Free the context of current thread,Quit() calls it before cleaning up libxml2
+         * 
+         */
+        static void ReleaseLocal() noexcept {
+            auto &local = LocalSlot();
+            xmlXPathFreeContext(local.ctxt);
+            local.ctxt = nullptr;
+        }
+
         xmlXPathContextPtr ctxt = nullptr;
+    friend class NodeRef;
+    friend void Quit();
 };
 /**
  * @brief XPath Expression on ctxt
@@ -758,23 +1918,5485 @@ class XPathContent {
  */
 class XPathExpression {
     public:
-        XPathExpression();
+        XPathExpression() = default;
         XPathExpression(const XPathExpression &) = delete;
-        XPathExpression(XPathExpression &&);
+        XPathExpression(XPathExpression && other) {
+            expr = other.expr;
+            other.expr = nullptr;
+        }
         ~XPathExpression() {
             xmlXPathFreeCompExpr(expr);
         }
 
         explicit XPathExpression(xmlXPathCompExprPtr p) : expr(p) {}
+
+        XPathExpression &operator =(XPathExpression &&other) {
+            if(this != &other){
+                xmlXPathFreeCompExpr(expr);
+                expr = other.expr;
+                other.expr = nullptr;
+            }
+            return *this;
+        }
+
+        bool is_null() const noexcept {
+            return expr == nullptr;
+        }
+        xmlXPathCompExprPtr get() const noexcept {
+            return expr;
+        }
+        /**
+         * @brief Compile a expression without context
+         * 
+         * @return XPathExpression (null on syntax error)
+         */
+        static XPathExpression Compile(u8string_view s) {
+            u8string str(s);
+            return XPathExpression(xmlXPathCompile(BAD_CAST str.c_str()));
+        }
     private:
         xmlXPathCompExprPtr expr = nullptr;
 };
+/**
+ * @brief Thread-safe LRU cache of compiled expressions,keyed by the expression text
+ * 
+ * @tparam T The compiled type,it needs static T Compile(u8string_view) and is_null()
+ * @note The compiled expression is read only during evaluation,so it is shared between threads
+ */
+template<class T>
+class CompileCache {
+    public:
+        using value_type = std::shared_ptr<const T>;
 
-//--Impl for find operations for NodeRef
-
-XPathObject NodeRef::xpath(u8string_view s) const {
-    XPathContent ctxt(document());
-    return ctxt.eval(*this,s);
-}
+        CompileCache(size_t capacity = LXML_XPATH_CACHE_SIZE) : cap(capacity) {}
+        CompileCache(const CompileCache &) = delete;
+        ~CompileCache() = default;
 
-LXML_NS_END
\ No newline at end of file
+        /**
+         * @brief Get the compiled expression,compile and insert it if missing
+         * 
+         * @return value_type (nullptr on syntax error,it is not cached)
+         */
+        value_type get(u8string_view s) {
+            {
+                std::lock_guard<std::mutex> locker(mutex);
+                auto iter = map.find(s);
+                if(iter != map.end()){
+                    ++hits;
+                    list.splice(list.begin(),list,iter->second);
+                    return iter->second->second;
+                }
+                ++misses;
+            }
+            //Compile without lock
+            u8string key(s);
+            auto expr = std::make_shared<const T>(T::Compile(key));
+            if(expr->is_null() || cap == 0){
+                return expr->is_null() ? nullptr : expr;
+            }
+
+            std::lock_guard<std::mutex> locker(mutex);
+            auto iter = map.find(s);
+            if(iter != map.end()){
+                //Another thread inserted it
+                list.splice(list.begin(),list,iter->second);
+                return iter->second->second;
+            }
+            list.emplace_front(std::move(key),expr);
+            map.emplace(list.front().first,list.begin());
+            shrink();
+            return expr;
+        }
+        void clear() {
+            std::lock_guard<std::mutex> locker(mutex);
+            map.clear();
+            list.clear();
+        }
+        void set_capacity(size_t capacity) {
+            std::lock_guard<std::mutex> locker(mutex);
+            cap = capacity;
+            shrink();
+        }
+        size_t capacity() const {
+            std::lock_guard<std::mutex> locker(mutex);
+            return cap;
+        }
+        size_t size() const {
+            std::lock_guard<std::mutex> locker(mutex);
+            return map.size();
+        }
+        size_t hit_count() const {
+            std::lock_guard<std::mutex> locker(mutex);
+            return hits;
+        }
+        size_t miss_count() const {
+            std::lock_guard<std::mutex> locker(mutex);
+            return misses;
+        }
+        /**
+         * @brief Get the global cache used by NodeRef::xpath / NodeRef::select
+         * 
+         * @return CompileCache& 
+         */
+        static CompileCache &Global() {
+            static CompileCache cache;
+            return cache;
+        }
+    private:
+        void shrink() {
+            while(map.size() > cap){
+                map.erase(list.back().first);
+                list.pop_back();
+            }
+        }
+        using Entry = std::pair<u8string,value_type>;
+
+        //Keys of map point into the strings in the list,list nodes never move
+        std::list<Entry> list;
+        std::unordered_map<u8string_view,typename std::list<Entry>::iterator> map;
+        mutable std::mutex mutex;
+        size_t cap;
+        size_t hits = 0;
+        size_t misses = 0;
+};
+using XPathCache = CompileCache<XPathExpression>;
+
+//--Impl XPathContent
+inline XPathExpression XPathContent::compile(u8string_view s) const {
+    u8string str(s);
+    return XPathExpression(xmlXPathCtxtCompile(ctxt,BAD_CAST str.c_str()));
+}
+inline XPathObject XPathContent::eval(const XPathExpression &expr) const {
+    return XPathObject(xmlXPathCompiledEval(expr.get(),ctxt));
+}
+inline XPathObject XPathContent::eval(NodeRef node,const XPathExpression &expr) const {
+    ctxt->node = node.get();
+    return XPathObject(xmlXPathCompiledEval(expr.get(),ctxt));
+}
+
+//--Impl Quit
+inline void Quit() {
+    XPathContent::ReleaseLocal();
+    xmlCleanupParser();
+    xmlCleanupGlobals();
+    xmlDictCleanup();
+}
+
+//--Impl for find operations for NodeRef
+
+inline XPathObject NodeRef::xpath(u8string_view s) const {
+    auto &ctxt = XPathContent::Local(document());
+    auto expr = XPathCache::Global().get(s);
+    if(expr == nullptr){
+        //Syntax error,let libxml2 report it
+        return ctxt.eval(*this,s);
+    }
+    return ctxt.eval(*this,*expr);
+}
+
+//--CSS Selector
+namespace Detail {
+    struct CssAttribute {
+        u8string name;
+        u8string value;
+        char     op;//< 0 on [name],or one of = ~ | ^ $ *
+    };
+    struct CssNth {
+        int  a;
+        int  b;
+        bool last;//< Count from the last sibling
+    };
+    struct CssCompound {
+        u8string                  tag;//< Empty on any
+        u8string                  id;
+        std::vector<u8string>     classes;
+        std::vector<CssAttribute> attributes;
+        std::vector<CssNth>       nths;
+        char                      combinator = 0;//< Relation to the compound on the left,' ' '>' '+' '~'
+    };
+    using CssComplex = std::vector<CssCompound>;
+
+    inline bool IsCssSpace(char c) noexcept {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+    }
+
+    inline bool AsciiEqualsNoCase(const xmlChar *s,u8string_view name) noexcept {
+        for(char c : name){
+            unsigned char a = *s++;
+            if(a == 0 || std::tolower(a) != std::tolower(static_cast<unsigned char>(c))){
+                return false;
+            }
+        }
+        return *s == 0;
+    }
+    /**
+     * @brief Compare a tag or attribute name,without case in html documents only
+     * 
+     */
+    inline bool CssNameEquals(const xmlNode *node,const xmlChar *s,u8string_view name) noexcept {
+        if(node->doc != nullptr && node->doc->type == XML_HTML_DOCUMENT_NODE){
+            return AsciiEqualsNoCase(s,name);
+        }
+        return NameEquals(s,name);
+    }
+    inline bool ContainsWord(u8string_view list,u8string_view word) noexcept {
+        size_t i = 0;
+        while(i < list.size()){
+            while(i < list.size() && IsCssSpace(list[i])){
+                i++;
+            }
+            size_t start = i;
+            while(i < list.size() && !IsCssSpace(list[i])){
+                i++;
+            }
+            if(list.substr(start,i - start) == word && i != start){
+                return true;
+            }
+        }
+        return false;
+    }
+    /**
+     * @brief Find the attribute of element,names are compared without case in html documents
+     * 
+     * @param scratch Storage of the value if it could not be borrowed
+     */
+    inline bool CssFindAttribute(const xmlNode *node,u8string_view name,u8string_view &value,lstring &scratch) {
+        for(xmlAttr *attr = node->properties;attr != nullptr;attr = attr->next){
+            if(!CssNameEquals(node,attr->name,name)){
+                continue;
+            }
+            if(!AttributeView(attr,value)){
+                scratch.reset(xmlNodeListGetString(node->doc,attr->children,1));
+                value = scratch.view();
+            }
+            return true;
+        }
+        return false;
+    }
+    inline bool CssMatchAttribute(const CssAttribute &attr,u8string_view value) noexcept {
+        const u8string &v = attr.value;
+        switch(attr.op){
+            case 0   : return true;
+            case '=' : return value == v;
+            case '~' : return !v.empty() && ContainsWord(value,v);
+            case '|' : return value == v || (value.size() > v.size() && value.compare(0,v.size(),v) == 0 && value[v.size()] == '-');
+            case '^' : return !v.empty() && value.compare(0,v.size(),v) == 0;
+            case '$' : return !v.empty() && value.size() >= v.size() && value.compare(value.size() - v.size(),v.size(),v) == 0;
+            case '*' : return !v.empty() && value.find(v) != u8string_view::npos;
+        }
+        return false;
+    }
+    inline bool CssMatchNth(const CssNth &nth,const xmlNode *node) noexcept {
+        int index = 1;
+        for(const xmlNode *cur = nth.last ? node->next : node->prev;cur != nullptr;cur = nth.last ? cur->next : cur->prev){
+            index += cur->type == XML_ELEMENT_NODE;
+        }
+        if(nth.a == 0){
+            return index == nth.b;
+        }
+        int diff = index - nth.b;
+        return diff % nth.a == 0 && diff / nth.a >= 0;
+    }
+    inline bool CssMatchCompound(const CssCompound &c,const xmlNode *node) {
+        if(node->type != XML_ELEMENT_NODE){
+            return false;
+        }
+        if(!c.tag.empty() && !CssNameEquals(node,node->name,c.tag)){
+            return false;
+        }
+        u8string_view value;
+        lstring       scratch;
+        if(!c.id.empty()){
+            if(!CssFindAttribute(node,"id",value,scratch) || value != c.id){
+                return false;
+            }
+        }
+        if(!c.classes.empty()){
+            if(!CssFindAttribute(node,"class",value,scratch)){
+                return false;
+            }
+            for(auto &cls : c.classes){
+                if(!ContainsWord(value,cls)){
+                    return false;
+                }
+            }
+        }
+        for(auto &attr : c.attributes){
+            if(!CssFindAttribute(node,attr.name,value,scratch) || !CssMatchAttribute(attr,value)){
+                return false;
+            }
+        }
+        for(auto &nth : c.nths){
+            if(!CssMatchNth(nth,node)){
+                return false;
+            }
+        }
+        return true;
+    }
+    inline const xmlNode *PrevElement(const xmlNode *node) noexcept {
+        do {
+            node = node->prev;
+        }
+        while(node != nullptr && node->type != XML_ELEMENT_NODE);
+        return node;
+    }
+    /**
+     * @brief Match the compounds [0,i] from right to left,node is the candidate of compound i
+     * 
+     */
+    inline bool CssMatch(const CssComplex &cs,size_t i,const xmlNode *node) {
+        if(!CssMatchCompound(cs[i],node)){
+            return false;
+        }
+        if(i == 0){
+            return true;
+        }
+        switch(cs[i].combinator){
+            case '>' : {
+                const xmlNode *parent = node->parent;
+                return parent != nullptr && parent->type == XML_ELEMENT_NODE && CssMatch(cs,i - 1,parent);
+            }
+            case ' ' : {
+                for(const xmlNode *cur = node->parent;cur != nullptr && cur->type == XML_ELEMENT_NODE;cur = cur->parent){
+                    if(CssMatch(cs,i - 1,cur)){
+                        return true;
+                    }
+                }
+                return false;
+            }
+            case '+' : {
+                const xmlNode *prev = PrevElement(node);
+                return prev != nullptr && CssMatch(cs,i - 1,prev);
+            }
+            case '~' : {
+                for(const xmlNode *cur = PrevElement(node);cur != nullptr;cur = PrevElement(cur)){
+                    if(CssMatch(cs,i - 1,cur)){
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+        return false;
+    }
+    /**
+     * @brief Recursive descent parser of css selector lists
+     * 
+     */
+    class CssParser {
+        public:
+            CssParser(u8string_view s) : s(s) {}
+
+            bool parse(std::vector<CssComplex> &list) {
+                do {
+                    CssComplex complex;
+                    if(!parse_complex(complex)){
+                        return false;
+                    }
+                    list.push_back(std::move(complex));
+                }
+                while(eat(','));
+                skip_spaces();
+                return i == s.size();
+            }
+        private:
+            bool parse_complex(CssComplex &complex) {
+                skip_spaces();
+                char combinator = 0;
+                while(true){
+                    CssCompound compound;
+                    compound.combinator = combinator;
+                    if(!parse_compound(compound)){
+                        return false;
+                    }
+                    complex.push_back(std::move(compound));
+
+                    bool spaces = skip_spaces();
+                    if(i < s.size() && (s[i] == '>' || s[i] == '+' || s[i] == '~')){
+                        combinator = s[i++];
+                        skip_spaces();
+                    }
+                    else if(spaces && i < s.size() && s[i] != ','){
+                        combinator = ' ';
+                    }
+                    else{
+                        return true;
+                    }
+                }
+            }
+            bool parse_compound(CssCompound &c) {
+                size_t start = i;
+                if(eat('*')){
+                    //Any
+                }
+                else if(peek_ident()){
+                    c.tag = ident();
+                }
+                while(i < s.size()){
+                    char ch = s[i];
+                    if(ch == '#'){
+                        i++;
+                        if(!peek_ident()){
+                            return false;
+                        }
+                        c.id = ident();
+                    }
+                    else if(ch == '.'){
+                        i++;
+                        if(!peek_ident()){
+                            return false;
+                        }
+                        c.classes.push_back(ident());
+                    }
+                    else if(ch == '['){
+                        i++;
+                        if(!parse_attribute(c)){
+                            return false;
+                        }
+                    }
+                    else if(ch == ':'){
+                        i++;
+                        if(!parse_pseudo(c)){
+                            return false;
+                        }
+                    }
+                    else{
+                        break;
+                    }
+                }
+                return i != start;
+            }
+            bool parse_attribute(CssCompound &c) {
+                CssAttribute attr;
+                skip_spaces();
+                if(!peek_ident()){
+                    return false;
+                }
+                attr.name = ident();
+                attr.op = 0;
+                skip_spaces();
+                if(i < s.size() && s[i] != ']'){
+                    char ch = s[i];
+                    if(ch != '='){
+                        if(u8string_view("~|^$*").find(ch) == u8string_view::npos){
+                            return false;
+                        }
+                        i++;
+                    }
+                    if(!eat('=')){
+                        return false;
+                    }
+                    attr.op = ch;
+                    skip_spaces();
+                    if(i < s.size() && (s[i] == '"' || s[i] == '\'')){
+                        if(!string(attr.value)){
+                            return false;
+                        }
+                    }
+                    else if(peek_ident()){
+                        attr.value = ident();
+                    }
+                    else{
+                        return false;
+                    }
+                    skip_spaces();
+                }
+                if(!eat(']')){
+                    return false;
+                }
+                c.attributes.push_back(std::move(attr));
+                return true;
+            }
+            bool parse_pseudo(CssCompound &c) {
+                if(!peek_ident()){
+                    return false;
+                }
+                u8string name = ident();
+                for(auto &ch : name){
+                    ch = std::tolower(static_cast<unsigned char>(ch));
+                }
+                if(name == "first-child"){
+                    c.nths.push_back({0,1,false});
+                }
+                else if(name == "last-child"){
+                    c.nths.push_back({0,1,true});
+                }
+                else if(name == "only-child"){
+                    c.nths.push_back({0,1,false});
+                    c.nths.push_back({0,1,true});
+                }
+                else if(name == "nth-child" || name == "nth-last-child"){
+                    CssNth nth;
+                    nth.last = name == "nth-last-child";
+                    if(!eat('(') || !parse_nth(nth) || !eat(')')){
+                        return false;
+                    }
+                    c.nths.push_back(nth);
+                }
+                else{
+                    //Unsupported
+                    return false;
+                }
+                return true;
+            }
+            //an+b,odd,even
+            bool parse_nth(CssNth &nth) {
+                skip_spaces();
+                size_t end = s.find(')',i);
+                if(end == u8string_view::npos){
+                    return false;
+                }
+                u8string expr;
+                for(;i < end;i++){
+                    if(!IsCssSpace(s[i])){
+                        expr += std::tolower(static_cast<unsigned char>(s[i]));
+                    }
+                }
+                if(expr == "odd"){
+                    nth.a = 2;
+                    nth.b = 1;
+                    return true;
+                }
+                if(expr == "even"){
+                    nth.a = 2;
+                    nth.b = 0;
+                    return true;
+                }
+                size_t n = expr.find('n');
+                if(n == u8string::npos){
+                    nth.a = 0;
+                    return Integer(expr,nth.b);
+                }
+                u8string a = expr.substr(0,n);
+                u8string b = expr.substr(n + 1);
+                if(a.empty() || a == "+"){
+                    nth.a = 1;
+                }
+                else if(a == "-"){
+                    nth.a = -1;
+                }
+                else if(!Integer(a,nth.a)){
+                    return false;
+                }
+                nth.b = 0;
+                if(b.empty()){
+                    return true;
+                }
+                if(b[0] != '+' && b[0] != '-'){
+                    return false;
+                }
+                return Integer(b,nth.b);
+            }
+            static bool Integer(const u8string &str,int &value) {
+                if(str.empty()){
+                    return false;
+                }
+                char *end;
+                errno = 0;
+                long v = std::strtol(str.c_str(),&end,10);
+                if(*end != '\0' || errno != 0 || v > INT_MAX || v < INT_MIN){
+                    return false;
+                }
+                value = int(v);
+                return true;
+            }
+            bool string(u8string &out) {
+                char quote = s[i++];
+                while(i < s.size() && s[i] != quote){
+                    if(s[i] == '\\' && i + 1 < s.size()){
+                        i++;
+                    }
+                    out += s[i++];
+                }
+                return eat(quote);
+            }
+            bool peek_ident() const noexcept {
+                if(i >= s.size()){
+                    return false;
+                }
+                unsigned char ch = s[i];
+                if(ch == '-' && i + 1 < s.size()){
+                    ch = s[i + 1];
+                }
+                return std::isalpha(ch) || ch == '_' || ch == '\\' || ch >= 0x80;
+            }
+            u8string ident() {
+                u8string out;
+                while(i < s.size()){
+                    unsigned char ch = s[i];
+                    if(ch == '\\' && i + 1 < s.size()){
+                        out += s[i + 1];
+                        i += 2;
+                    }
+                    else if(std::isalnum(ch) || ch == '-' || ch == '_' || ch >= 0x80){
+                        out += s[i++];
+                    }
+                    else{
+                        break;
+                    }
+                }
+                return out;
+            }
+            bool eat(char ch) noexcept {
+                if(i < s.size() && s[i] == ch){
+                    i++;
+                    return true;
+                }
+                return false;
+            }
+            bool skip_spaces() noexcept {
+                size_t start = i;
+                while(i < s.size() && IsCssSpace(s[i])){
+                    i++;
+                }
+                return i != start;
+            }
+
+            u8string_view s;
+            size_t        i = 0;
+    };
+}
+/**
+ * @brief Compiled css selector,matched from right to left directly on xmlNode
+ * 
+ * Supports type,universal,#id,.class,[attr] ([a=v] [a~=v] [a|=v] [a^=v] [a$=v] [a*=v]),
+ * :first-child,:last-child,:only-child,:nth-child(an+b),:nth-last-child(an+b),
+ * the descendant,child (>),adjacent (+) and sibling (~) combinators and selector lists (,).
+ * 
+ * @note It is a cheap handle of the immutable compiled form,copy and share it between threads
+ */
+class Selector {
+    public:
+        Selector() = default;
+        Selector(const Selector &) = default;
+        Selector(Selector &&) = default;
+        ~Selector() = default;
+
+        Selector &operator =(const Selector &) = default;
+        Selector &operator =(Selector &&) = default;
+
+        bool is_null() const noexcept {
+            return list == nullptr;
+        }
+        /**
+         * @brief Check the node matches the selector
+         * 
+         */
+        bool match(NodeRef node) const {
+            if(list == nullptr || node.is_null()){
+                return false;
+            }
+            for(auto &complex : *list){
+                if(Detail::CssMatch(complex,complex.size() - 1,node.get())){
+                    return true;
+                }
+            }
+            return false;
+        }
+        bool operator ()(const NodeRef &node) const {
+            return match(node);
+        }
+        /**
+         * @brief Compile a css selector
+         * 
+         * @return Selector (null on syntax error or unsupported pseudo class)
+         */
+        static Selector Compile(u8string_view css) {
+            auto list = std::make_shared<std::vector<Detail::CssComplex>>();
+            if(!Detail::CssParser(css).parse(*list)){
+                return Selector();
+            }
+            Selector selector;
+            selector.list = std::move(list);
+            return selector;
+        }
+    private:
+        std::shared_ptr<const std::vector<Detail::CssComplex>> list;
+};
+using SelectorCache = CompileCache<Selector>;
+
+//--Impl css selector for NodeRef
+inline Selection NodeRef::select(const Selector &selector) const {
+    return Selection(selector.is_null() ? nullptr : node,selector);
+}
+inline Selection NodeRef::select(u8string_view css) const {
+    auto selector = SelectorCache::Global().get(css);
+    if(selector == nullptr){
+        return Selection(nullptr,Selector());
+    }
+    return select(*selector);
+}
+inline NodeRef NodeRef::select_first(const Selector &selector) const {
+    return select(selector).first();
+}
+inline NodeRef NodeRef::select_first(u8string_view css) const {
+    return select(css).first();
+}
+inline bool NodeRef::matches(const Selector &selector) const {
+    return selector.match(*this);
+}
+
+//--Compile-time path
+namespace Detail {
+    inline bool PathStepMatch(const xmlNode *node,u8string_view step) noexcept {
+        if(node->type != XML_ELEMENT_NODE){
+            return false;
+        }
+        if(step.size() == 1 && step[0] == '*'){
+            return true;
+        }
+        return NameEquals(node->name,step);
+    }
+    /**
+     * @brief First match of the steps D.. under the parent,the walk is unrolled by the depth
+     * 
+     * @tparam Q PathQuery or StaticPathQuery,Q::match_step<D>() matches a node against the step D
+     */
+    template<size_t D,class Q>
+    xmlNode *PathFirst(const Q &query,xmlNode *parent) noexcept {
+        for(xmlNode *c = parent->children;c != nullptr;c = c->next){
+            if(!query.template match_step<D>(c)){
+                continue;
+            }
+            if constexpr(D + 1 == Q::Size){
+                return c;
+            }
+            else if(xmlNode *ret = PathFirst<D + 1>(query,c); ret != nullptr){
+                return ret;
+            }
+        }
+        return nullptr;
+    }
+}
+/**
+ * @brief Iterator over the matches of a PathQuery,it only holds the current node
+ * 
+ */
+template<class Q>
+class PathIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = NodeRef;
+        using difference_type = std::ptrdiff_t;
+        using pointer = NodeRef;
+        using reference = NodeRef;
+
+        PathIterator() = default;
+        PathIterator(xmlNode *root,const Q *query) : root(root), query(query) {
+            if(root != nullptr){
+                settle(root,root->children,0);
+            }
+        }
+
+        bool operator ==(const PathIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const PathIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        PathIterator &operator ++() noexcept {
+            settle(cur->parent,cur->next,Q::Size - 1);
+            return *this;
+        }
+        PathIterator operator ++(int) noexcept {
+            PathIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        NodeRef operator  *() const noexcept {
+            return NodeRef(cur);
+        }
+        NodeRef operator ->() const noexcept {
+            return NodeRef(cur);
+        }
+    private:
+        /**
+         * @brief Find the next match from c (a child of parent at the depth),backtrack by the parent pointers
+         * 
+         */
+        void settle(xmlNode *parent,xmlNode *c,size_t depth) noexcept {
+            while(true){
+                while(c != nullptr && !query->match(c,depth)){
+                    c = c->next;
+                }
+                if(c == nullptr){
+                    if(depth == 0){
+                        cur = nullptr;
+                        return;
+                    }
+                    c = parent->next;
+                    parent = parent->parent;
+                    depth -= 1;
+                    continue;
+                }
+                if(depth + 1 == Q::Size){
+                    cur = c;
+                    return;
+                }
+                parent = c;
+                c = c->children;
+                depth += 1;
+            }
+        }
+        xmlNode *root = nullptr;
+        xmlNode *cur = nullptr;
+        const Q *query = nullptr;
+};
+/**
+ * @brief Lazy range of the matches of a PathQuery,it holds a copy of the query
+ * 
+ * @note The iterators refer to the range,keep it alive while iterating
+ */
+template<class Q>
+class PathRange {
+    public:
+        using iterator = PathIterator<Q>;
+        using const_iterator = PathIterator<Q>;
+        using value_type = NodeRef;
+
+        PathRange(xmlNode *root,const Q &query) : root(root), query(query) {}
+
+        iterator begin() const noexcept {
+            return iterator(root,&query);
+        }
+        iterator end() const noexcept {
+            return iterator();
+        }
+        NodeRef first() const noexcept {
+            return query.first(NodeRef(root));
+        }
+        bool empty() const noexcept {
+            return first().is_null();
+        }
+    private:
+        xmlNode *root;
+        Q        query;
+};
+/**
+ * @brief Fixed path of child element names,built at compile time
+ * 
+ * @code
+ * constexpr auto links = LXml::Path("feed") / "entry" / "link";
+ * for(auto link : links.all(doc)){ ... }
+ * @endcode
+ * 
+ * Each step matches the child elements by name ("*" for any),
+ * the walk is inlined and allocates nothing,unlike the xpath "/feed/entry/link".
+ * From a DocumentRef the first step matches the root element.
+ * The names are views compared at runtime,LXml::path<"feed","entry","link"> (C++20) compiles them in.
+ */
+template<size_t N>
+class PathQuery {
+    public:
+        static_assert(N > 0,"PathQuery needs one step at least");
+        static constexpr size_t Size = N;
+
+        constexpr PathQuery(const u8string_view (&s)[N]) {
+            for(size_t i = 0;i < N;i++){
+                steps[i] = s[i];
+            }
+        }
+        /**
+         * @brief Append a step
+         * 
+         */
+        constexpr PathQuery<N + 1> operator /(u8string_view step) const {
+            u8string_view s[N + 1] = {};
+            for(size_t i = 0;i < N;i++){
+                s[i] = steps[i];
+            }
+            s[N] = step;
+            return PathQuery<N + 1>(s);
+        }
+        constexpr u8string_view operator [](size_t i) const {
+            return steps[i];
+        }
+        constexpr size_t size() const noexcept {
+            return N;
+        }
+        /**
+         * @brief Get all the matches under the node,lazily walked
+         * 
+         */
+        PathRange<PathQuery> all(NodeRef node) const noexcept {
+            return PathRange<PathQuery>(node.get(),*this);
+        }
+        PathRange<PathQuery> all(DocumentRef doc) const noexcept {
+            return all(DocNode(doc));
+        }
+        /**
+         * @brief Get the first match under the node
+         * 
+         * @return NodeRef (null on none)
+         */
+        NodeRef first(NodeRef node) const noexcept {
+            if(node.is_null()){
+                return NodeRef();
+            }
+            return NodeRef(Detail::PathFirst<0>(*this,node.get()));
+        }
+        NodeRef first(DocumentRef doc) const noexcept {
+            return first(DocNode(doc));
+        }
+
+        bool match(const xmlNode *node,size_t depth) const noexcept {
+            return Detail::PathStepMatch(node,steps[depth]);
+        }
+        template<size_t D>
+        bool match_step(const xmlNode *node) const noexcept {
+            return Detail::PathStepMatch(node,steps[D]);
+        }
+    private:
+        static NodeRef DocNode(DocumentRef doc) noexcept {
+            //xmlDoc shares the tree layout of xmlNode
+            return NodeRef(reinterpret_cast<xmlNode*>(doc.get()));
+        }
+
+        u8string_view steps[N] = {};
+};
+/**
+ * @brief Begin a PathQuery
+ * 
+ */
+constexpr PathQuery<1> Path(u8string_view step) {
+    u8string_view s[1] = {step};
+    return PathQuery<1>(s);
+}
+
+#if LXML_CXX20
+namespace Detail {
+    template<size_t N>
+    struct FixedString {
+        char data[N] = {};
+
+        constexpr FixedString(const char (&s)[N]) {
+            for(size_t i = 0;i < N;i++){
+                data[i] = s[i];
+            }
+        }
+        constexpr u8string_view view() const {
+            return u8string_view(data,N - 1);
+        }
+    };
+}
+/**
+ * @brief PathQuery whose names are template arguments,made by LXml::path<"feed","entry","link">
+ * 
+ * Every step compares the node name against its literal,the first char and the length are constants,
+ * so most of the siblings are rejected by one compare and the rest by a fixed size strncmp.
+ */
+template<Detail::FixedString ...Steps>
+class StaticPathQuery {
+    public:
+        static constexpr size_t Size = sizeof...(Steps);
+        static_assert(Size > 0,"PathQuery needs one step at least");
+        static_assert(((Steps.view().size() > 0) && ...),"PathQuery needs non empty names");
+
+        constexpr u8string_view operator [](size_t i) const {
+            return Names[i];
+        }
+        constexpr size_t size() const noexcept {
+            return Size;
+        }
+        PathRange<StaticPathQuery> all(NodeRef node) const noexcept {
+            return PathRange<StaticPathQuery>(node.get(),*this);
+        }
+        PathRange<StaticPathQuery> all(DocumentRef doc) const noexcept {
+            return all(DocNode(doc));
+        }
+        NodeRef first(NodeRef node) const noexcept {
+            if(node.is_null()){
+                return NodeRef();
+            }
+            return NodeRef(Detail::PathFirst<0>(*this,node.get()));
+        }
+        NodeRef first(DocumentRef doc) const noexcept {
+            return first(DocNode(doc));
+        }
+
+        bool match(const xmlNode *node,size_t depth) const noexcept {
+            return MatchAt(node,depth,std::make_index_sequence<Size>());
+        }
+        template<size_t D>
+        bool match_step(const xmlNode *node) const noexcept {
+            if(node->type != XML_ELEMENT_NODE){
+                return false;
+            }
+            if constexpr(Names[D] == "*"){
+                return true;
+            }
+            else{
+                return NameIs<D>(node->name);
+            }
+        }
+    private:
+        static constexpr u8string_view Names[Size] = {Steps.view()...};
+
+        template<size_t D>
+        static bool NameIs(const xmlChar *name) noexcept {
+            constexpr u8string_view step = Names[D];
+            //The first char rejects most of the siblings,strncmp stops at the NUL of a shorter name
+            return name[0] == xmlChar(step[0]) &&
+                   std::strncmp(reinterpret_cast<const char*>(name),step.data(),step.size()) == 0 &&
+                   name[step.size()] == 0;
+        }
+        template<size_t ...D>
+        bool MatchAt(const xmlNode *node,size_t depth,std::index_sequence<D...>) const noexcept {
+            bool ret = false;
+            ((depth == D && (ret = match_step<D>(node),true)) || ...);
+            return ret;
+        }
+        static NodeRef DocNode(DocumentRef doc) noexcept {
+            return NodeRef(reinterpret_cast<xmlNode*>(doc.get()));
+        }
+};
+/**
+ * @brief StaticPathQuery from string literals,like LXml::path<"feed","entry","link">
+ * 
+ */
+template<Detail::FixedString ...Steps>
+inline constexpr StaticPathQuery<Steps...> path = {};
+#endif
+
+LXML_NS_END
+
+//--PushParser
+LXML_NS_BEGIN
+namespace Detail {
+    /**
+     * @brief libxml2 takes the size as int,hand the huge data to feed(data,int size) piece by piece
+     * 
+     * @return false once feed returns non zero
+     */
+    template<class Fn>
+    bool FeedPieces(const char *data,size_t size,Fn &&feed) {
+        do{
+            int n = size < size_t(INT_MAX) ? int(size) : INT_MAX;
+            if(feed(data,n) != 0){
+                return false;
+            }
+            data += n;
+            size -= n;
+        }
+        while(size > 0);
+        return true;
+    }
+}
+/**
+ * @brief Incremental parser,feed the data chunk by chunk and get the document at last
+ * 
+ * @tparam T XmlDocument or HtmlDocument
+ */
+template<class T>
+class PushParser {
+    public:
+        static_assert(
+            std::is_same<T,XmlDocument>::value || std::is_same<T,HtmlDocument>::value,
+            "PushParser only supports XmlDocument or HtmlDocument"
+        );
+        static constexpr bool IsHtml = std::is_same<T,HtmlDocument>::value;
+
+        PushParser(int opt = DefaultOptions) : opt(opt) {}
+        PushParser(const PushParser &) = delete;
+        PushParser(PushParser &&other) : ctxt(other.ctxt), opt(other.opt) {
+            other.ctxt = nullptr;
+        }
+        ~PushParser() {
+            reset();
+        }
+
+        PushParser &operator =(PushParser &&other) {
+            if(this != &other){
+                reset();
+                ctxt = other.ctxt;
+                opt = other.opt;
+                other.ctxt = nullptr;
+            }
+            return *this;
+        }
+    public:
+        /**
+         * @brief Parse a chunk,the data is copied into the parser,so the chunk could be released after return
+         * 
+         * @return true on success,false on fatal error
+         */
+        bool feed(u8string_view chunk) {
+            if(ctxt == nullptr){
+                create();
+            }
+            return Detail::FeedPieces(chunk.data(),chunk.size(),[this](const char *data,int n){
+                return chunk_impl(data,n,0);
+            });
+        }
+        /**
+         * @brief Terminate the parsing and get the document,the parser could be used for next document after it
+         * 
+         * @return T 
+         */
+        T finish() {
+            if(ctxt == nullptr){
+                create();
+            }
+            chunk_impl(nullptr,0,1);
+
+            xmlDocPtr doc = ctxt->myDoc;
+            ctxt->myDoc = nullptr;
+            if(doc != nullptr && !ctxt->wellFormed && !(opt & Recover)){
+                xmlFreeDoc(doc);
+                doc = nullptr;
+            }
+            reset();
+#ifndef LXML_NO_EXCEPTIONS
+            if(doc == nullptr){
+                LXML_THROW(std::runtime_error(
+                    IsHtml ? "Failed to parse html document" : "Failed to parse xml document"
+                ));
+            }
+#endif
+            return T(doc);
+        }
+        /**
+         * @brief Drop the current progress
+         * 
+         */
+        void reset() {
+            if(ctxt == nullptr){
+                return;
+            }
+            if(ctxt->myDoc != nullptr){
+                xmlFreeDoc(ctxt->myDoc);
+                ctxt->myDoc = nullptr;
+            }
+            if constexpr(IsHtml){
+                htmlFreeParserCtxt(ctxt);
+            }
+            else{
+                xmlFreeParserCtxt(ctxt);
+            }
+            ctxt = nullptr;
+        }
+
+        xmlParserCtxtPtr get() const noexcept {
+            return ctxt;
+        }
+    private:
+        void create() {
+            if constexpr(IsHtml){
+                ctxt = htmlCreatePushParserCtxt(nullptr,nullptr,nullptr,0,nullptr,XML_CHAR_ENCODING_UTF8);
+                LXML_CHECK(ctxt != nullptr);
+                htmlCtxtUseOptions(ctxt,opt);
+            }
+            else{
+                ctxt = xmlCreatePushParserCtxt(nullptr,nullptr,nullptr,0,nullptr);
+                LXML_CHECK(ctxt != nullptr);
+                xmlCtxtUseOptions(ctxt,opt);
+            }
+        }
+        int chunk_impl(const char *data,int size,int terminate) {
+            if constexpr(IsHtml){
+                return htmlParseChunk(ctxt,data,size,terminate);
+            }
+            else{
+                return xmlParseChunk(ctxt,data,size,terminate);
+            }
+        }
+
+        xmlParserCtxtPtr ctxt = nullptr;
+        int              opt;
+};
+
+using XmlPushParser = PushParser<XmlDocument>;
+using HtmlPushParser = PushParser<HtmlDocument>;
+
+/**
+ * @brief Reusable parser context for many documents,it skips the setup of a new context per parse
+ *        and (for xml) reads the input in place
+ * 
+ * The context keeps its xmlDict between parses,so the names are interned once and shared by all
+ * the documents it produced. The dict could also be shared with other contexts by set_dict().
+ * 
+ * @tparam T XmlDocument or HtmlDocument
+ * @note A context (and a dict shared by contexts) must only be used by one thread at a time
+ */
+template<class T>
+class ParserContext {
+    public:
+        static_assert(
+            std::is_same<T,XmlDocument>::value || std::is_same<T,HtmlDocument>::value,
+            "ParserContext only supports XmlDocument or HtmlDocument"
+        );
+        static constexpr bool IsHtml = std::is_same<T,HtmlDocument>::value;
+
+        ParserContext(int opt = DefaultOptions) : opt(opt) {}
+        /**
+         * @brief Construct a new Parser Context using the dict
+         * 
+         * @param dict The dict to share,it is referenced by the context
+         */
+        ParserContext(xmlDictPtr dict,int opt = DefaultOptions) : opt(opt) {
+            set_dict(dict);
+        }
+        ParserContext(const ParserContext &) = delete;
+        ParserContext(ParserContext &&other) : ctxt(other.ctxt), opt(other.opt) {
+            other.ctxt = nullptr;
+        }
+        ~ParserContext() {
+            release();
+        }
+
+        ParserContext &operator =(ParserContext &&other) {
+            if(this != &other){
+                release();
+                ctxt = other.ctxt;
+                opt = other.opt;
+                other.ctxt = nullptr;
+            }
+            return *this;
+        }
+    public:
+        /**
+         * @brief Parse a document from a string,the context is reset and reused
+         * 
+         * @return T 
+         */
+        T parse(u8string_view str) {
+            if(ctxt == nullptr){
+                create();
+            }
+            xmlDocPtr doc;
+            if constexpr(IsHtml){
+                //Keep the UTF-8 encoder,without it the html parser switches the encoding by <meta>
+                doc = htmlCtxtReadMemory(ctxt,str.data(),str.size(),"","UTF-8",opt);
+            }
+            else{
+                doc = read_memory(str);
+            }
+#ifndef LXML_NO_EXCEPTIONS
+            if(doc == nullptr){
+                LXML_THROW(std::runtime_error(
+                    IsHtml ? "Failed to parse html document" : "Failed to parse xml document"
+                ));
+            }
+#endif
+            return T(doc);
+        }
+        /**
+         * @brief Use the dict for the next documents,the documents parsed before keep the old one
+         * 
+         */
+        void set_dict(xmlDictPtr dict) {
+            if(ctxt == nullptr){
+                create();
+            }
+            if(dict == ctxt->dict){
+                return;
+            }
+            xmlDictReference(dict);
+            xmlDictFree(ctxt->dict);
+            ctxt->dict = dict;
+            //The context caches some names interned in its dict
+            ctxt->str_xml = xmlDictLookup(dict,BAD_CAST "xml",3);
+            ctxt->str_xmlns = xmlDictLookup(dict,BAD_CAST "xmlns",5);
+            ctxt->str_xml_ns = xmlDictLookup(dict,XML_XML_NAMESPACE,36);
+        }
+        /**
+         * @brief Start a new dict,drop the names interned so far (the dict grows with every distinct name)
+         * 
+         */
+        void reset_dict() {
+            xmlDictPtr dict = xmlDictCreate();
+            LXML_CHECK(dict != nullptr);
+            set_dict(dict);
+            xmlDictFree(dict);
+        }
+        xmlDictPtr dict() {
+            if(ctxt == nullptr){
+                create();
+            }
+            return ctxt->dict;
+        }
+        size_t dict_size() const {
+            return ctxt == nullptr ? 0 : xmlDictSize(ctxt->dict);
+        }
+        xmlParserCtxtPtr get() const noexcept {
+            return ctxt;
+        }
+    private:
+        void create() {
+            if constexpr(IsHtml){
+                ctxt = htmlNewParserCtxt();
+            }
+            else{
+                ctxt = xmlNewParserCtxt();
+            }
+            LXML_CHECK(ctxt != nullptr);
+        }
+        /**
+         * @brief Like xmlCtxtReadMemory(...,"UTF-8",...),but the input is read in place
+         *        instead of being copied through the UTF-8 encoder
+         * 
+         */
+        xmlDocPtr read_memory(u8string_view str) {
+            xmlCtxtReset(ctxt);
+            xmlParserInputBufferPtr buf = xmlParserInputBufferCreateStatic(
+                str.data(),str.size(),XML_CHAR_ENCODING_NONE
+            );
+            if(buf == nullptr){
+                return nullptr;
+            }
+            xmlParserInputPtr input = xmlNewIOInputStream(ctxt,buf,XML_CHAR_ENCODING_NONE);
+            if(input == nullptr){
+                xmlFreeParserInputBuffer(buf);
+                return nullptr;
+            }
+            input->filename = reinterpret_cast<const char*>(xmlStrdup(BAD_CAST ""));
+            inputPush(ctxt,input);
+            //The content is taken as UTF-8,so the encoding declaration is ignored as xmlReadMemory with "UTF-8" does
+            xmlCtxtUseOptions(ctxt,opt | XML_PARSE_IGNORE_ENC);
+            ctxt->charset = XML_CHAR_ENCODING_UTF8;
+            xmlParseDocument(ctxt);
+
+            xmlDocPtr doc = ctxt->myDoc;
+            ctxt->myDoc = nullptr;
+            if(doc != nullptr && !ctxt->wellFormed && !ctxt->recovery){
+                xmlFreeDoc(doc);
+                doc = nullptr;
+            }
+            if(doc != nullptr && doc->encoding == nullptr){
+                doc->encoding = xmlStrdup(BAD_CAST "UTF-8");
+            }
+            return doc;
+        }
+        void release() {
+            if(ctxt == nullptr){
+                return;
+            }
+            if constexpr(IsHtml){
+                htmlFreeParserCtxt(ctxt);
+            }
+            else{
+                xmlFreeParserCtxt(ctxt);
+            }
+            ctxt = nullptr;
+        }
+
+        xmlParserCtxtPtr ctxt = nullptr;
+        int              opt;
+};
+
+using XmlParserContext = ParserContext<XmlDocument>;
+using HtmlParserContext = ParserContext<HtmlDocument>;
+
+//--Impl ParseFile
+namespace Detail {
+    /**
+     * @brief Read only mapping of a whole file,with sequential access hint
+     * 
+     */
+    class MappedFile {
+        public:
+            MappedFile(const char *path) {
+#if LXML_POSIX
+                int fd = ::open(path,O_RDONLY);
+                if(fd < 0){
+                    return;
+                }
+                struct stat st;
+                if(::fstat(fd,&st) == 0 && S_ISREG(st.st_mode)){
+                    //Empty file is mapped as a empty buffer
+                    mapped = true;
+                    if(st.st_size > 0){
+                        void *p = ::mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+                        if(p != MAP_FAILED){
+                            ::madvise(p,st.st_size,MADV_SEQUENTIAL);
+                            addr = p;
+                            len = st.st_size;
+                        }
+                        else{
+                            mapped = false;
+                        }
+                    }
+                }
+                ::close(fd);
+#else
+                (void) path;
+#endif
+            }
+            MappedFile(const MappedFile &) = delete;
+            ~MappedFile() {
+#if LXML_POSIX
+                if(addr != nullptr){
+                    ::munmap(addr,len);
+                }
+#endif
+            }
+
+            bool is_mapped() const noexcept {
+                return mapped;
+            }
+            const char *data() const noexcept {
+                return addr == nullptr ? "" : static_cast<const char *>(addr);
+            }
+            size_t size() const noexcept {
+                return len;
+            }
+            /**
+             * @brief Tell the kernel the range is consumed,so its pages could be dropped
+             * 
+             */
+            void discard(size_t offset,size_t n) noexcept {
+#if LXML_POSIX
+                static const size_t page = ::sysconf(_SC_PAGESIZE);
+                size_t begin = (offset + page - 1) / page * page;
+                size_t end = (offset + n) / page * page;
+                if(addr != nullptr && end > begin){
+                    ::madvise(static_cast<char *>(addr) + begin,end - begin,MADV_DONTNEED);
+                }
+#else
+                (void) offset;
+                (void) n;
+#endif
+            }
+        private:
+            void  *addr = nullptr;
+            size_t len = 0;
+            bool   mapped = false;
+    };
+    template<class T>
+    T ParseFile(const char *path,int opt) {
+        MappedFile file(path);
+        if(!file.is_mapped()){
+            //Not a regular file,let libxml2 read it
+            xmlDocPtr doc = PushParser<T>::IsHtml ? htmlReadFile(path,nullptr,opt) : xmlReadFile(path,nullptr,opt);
+#ifndef LXML_NO_EXCEPTIONS
+            if(doc == nullptr){
+                LXML_THROW(std::runtime_error(
+                    PushParser<T>::IsHtml ? "Failed to parse html document" : "Failed to parse xml document"
+                ));
+            }
+#endif
+            return T(doc);
+        }
+        //Feed the mapping by chunks,the parsed pages are dropped at once
+        PushParser<T> parser(opt);
+        u8string_view data(file.data(),file.size());
+        for(size_t offset = 0;offset < data.size();offset += LXML_FILE_CHUNK_SIZE){
+            auto chunk = data.substr(offset,LXML_FILE_CHUNK_SIZE);
+            parser.feed(chunk);
+            file.discard(offset,chunk.size());
+        }
+        T doc = parser.finish();
+        if(doc.get() != nullptr && doc.get()->URL == nullptr){
+            doc.get()->URL = xmlStrdup(BAD_CAST path);
+        }
+        return doc;
+    }
+}
+
+inline XmlDocument XmlDocument::ParseFile(const char *path,int opt) {
+    return Detail::ParseFile<XmlDocument>(path,opt);
+}
+inline HtmlDocument HtmlDocument::ParseFile(const char *path,int opt) {
+    return Detail::ParseFile<HtmlDocument>(path,opt);
+}
+
+LXML_NS_END
+
+//--AsyncParse
+#if LXML_CXX20
+LXML_NS_BEGIN
+namespace Detail {
+    template<class A>
+    decltype(auto) GetAwaiter(A &&a) {
+        if constexpr(requires { static_cast<A&&>(a).operator co_await(); }){
+            return static_cast<A&&>(a).operator co_await();
+        }
+        else{
+            return static_cast<A&&>(a);
+        }
+    }
+    template<class A>
+    using AwaitResult = decltype(GetAwaiter(std::declval<A>()).await_resume());
+}
+/**
+ * @brief Async byte stream,co_await s.read_some() gives the next chunk,an empty one on the end
+ * 
+ * The chunk only needs to stay valid until the next read_some()
+ */
+template<class S>
+concept AsyncByteStream = requires(S &s) {
+    { Detail::GetAwaiter(s.read_some()).await_ready() } -> std::convertible_to<bool>;
+    requires std::convertible_to<Detail::AwaitResult<decltype(s.read_some())>,u8string_view>;
+};
+
+/**
+ * @brief Lazy coroutine task,it starts on co_await (or start()) and resumes the awaiter on completion
+ * 
+ * @tparam T The result
+ */
+template<class T>
+class AsyncTask {
+    public:
+        struct promise_type {
+            std::optional<T>        value;
+            std::exception_ptr      error;
+            std::coroutine_handle<> continuation;
+
+            AsyncTask get_return_object() noexcept {
+                return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+            auto final_suspend() noexcept {
+                struct Final {
+                    bool await_ready() const noexcept {
+                        return false;
+                    }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                        auto next = h.promise().continuation;
+                        return next ? next : std::noop_coroutine();
+                    }
+                    void await_resume() const noexcept {}
+                };
+                return Final{};
+            }
+            void return_value(T v) {
+                value.emplace(std::move(v));
+            }
+            void unhandled_exception() noexcept {
+#ifndef LXML_NO_EXCEPTIONS
+                error = std::current_exception();
+#else
+                std::terminate();
+#endif
+            }
+        };
+
+        AsyncTask(const AsyncTask &) = delete;
+        AsyncTask(AsyncTask &&other) noexcept : handle(other.handle), started(other.started) {
+            other.handle = nullptr;
+        }
+        ~AsyncTask() {
+            if(handle){
+                handle.destroy();
+            }
+        }
+    public:
+        /**
+         * @brief Run the task until its first suspension,for driving it outside a coroutine
+         * 
+         */
+        void start() {
+            if(!started){
+                started = true;
+                handle.resume();
+            }
+        }
+        bool done() const noexcept {
+            return handle && handle.done();
+        }
+        /**
+         * @brief Get the result of a done task,it rethrows the exception of the task
+         * 
+         */
+        T result() {
+            LXML_CHECK(done());
+            auto &promise = handle.promise();
+            if(promise.error){
+                std::rethrow_exception(promise.error);
+            }
+            return std::move(*promise.value);
+        }
+
+        //--Awaiter
+        bool await_ready() const noexcept {
+            return done();
+        }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+            started = true;
+            handle.promise().continuation = awaiter;
+            return handle;
+        }
+        T await_resume() {
+            return result();
+        }
+    private:
+        explicit AsyncTask(std::coroutine_handle<promise_type> h) noexcept : handle(h) {}
+
+        std::coroutine_handle<promise_type> handle;
+        bool                                started = false;
+};
+
+/**
+ * @brief Parse a document from an async byte stream,the chunks are fed into a push parser
+ *        and the coroutine suspends while the stream waits for data
+ * 
+ * @note The stream must outlive the task
+ * 
+ * @code
+ *  auto doc = co_await LXml::AsyncParse(stream);
+ * @endcode
+ */
+template<class T = XmlDocument,AsyncByteStream S>
+AsyncTask<T> AsyncParse(S &stream,int opt = DefaultOptions) {
+    PushParser<T> parser(opt);
+    while(true){
+        u8string_view chunk = co_await stream.read_some();
+        if(chunk.empty() || !parser.feed(chunk)){
+            break;
+        }
+    }
+    co_return parser.finish();
+}
+
+/**
+ * @brief AsyncByteStream over a memory buffer,every read is ready at once,for tests
+ * 
+ */
+class MemoryStream {
+    public:
+        MemoryStream(u8string_view data,size_t chunk_size = LXML_FILE_CHUNK_SIZE) :
+            data(data), chunk_size(chunk_size == 0 ? 1 : chunk_size) {}
+
+        auto read_some() noexcept {
+            struct Awaiter {
+                u8string_view chunk;
+
+                bool await_ready() const noexcept {
+                    return true;
+                }
+                void await_suspend(std::coroutine_handle<>) const noexcept {}
+                u8string_view await_resume() const noexcept {
+                    return chunk;
+                }
+            };
+            u8string_view chunk = data.substr(0,chunk_size);
+            data.remove_prefix(chunk.size());
+            return Awaiter{chunk};
+        }
+    private:
+        u8string_view data;
+        size_t        chunk_size;
+};
+
+LXML_NS_END
+#endif
+
+//--SAX
+LXML_NS_BEGIN
+/**
+ * @brief Attribute passed to SAX callbacks,the views are valid in the callback only
+ * 
+ * @note The predefined and character references in value are decoded (e.g. &#38; to &),
+ *       references to the DTD entities are kept as is unless NoEntities is set
+ */
+struct SAXAttribute {
+    u8string_view name;
+    u8string_view value;
+};
+/**
+ * @brief Iterator over the SAX2 attribute array (localname/prefix/URI/value/end)
+ * 
+ */
+class SAXAttributeIterator {
+    public:
+        SAXAttributeIterator() = default;
+        SAXAttributeIterator(const xmlChar **attrs) : attrs(attrs) {}
+
+        bool operator ==(const SAXAttributeIterator &iter) const noexcept {
+            return attrs == iter.attrs;
+        }
+        bool operator !=(const SAXAttributeIterator &iter) const noexcept {
+            return attrs != iter.attrs;
+        }
+        SAXAttributeIterator &operator ++() noexcept {
+            attrs += 5;
+            return *this;
+        }
+        SAXAttributeIterator operator ++(int) noexcept {
+            SAXAttributeIterator tmp(*this);
+            attrs += 5;
+            return tmp;
+        }
+        SAXAttribute operator *() const noexcept {
+            return SAXAttribute{
+                ToView(attrs[0]),
+                u8string_view(reinterpret_cast<const char_t *>(attrs[3]),attrs[4] - attrs[3])
+            };
+        }
+    private:
+        const xmlChar **attrs = nullptr;
+};
+class SAXAttributes {
+    public:
+        using iterator = SAXAttributeIterator;
+        using const_iterator = SAXAttributeIterator;
+        using value_type = SAXAttribute;
+
+        SAXAttributes() = default;
+        SAXAttributes(const xmlChar **attrs,int n) : attrs(attrs), n(n) {}
+
+        iterator begin() const noexcept {
+            return iterator(attrs);
+        }
+        iterator end() const noexcept {
+            return iterator(attrs + n * 5);
+        }
+        size_t size() const noexcept {
+            return n;
+        }
+        bool empty() const noexcept {
+            return n == 0;
+        }
+        bool has(u8string_view name) const noexcept {
+            for(auto attr : *this){
+                if(attr.name == name){
+                    return true;
+                }
+            }
+            return false;
+        }
+        /**
+         * @brief Get the value of the attribute
+         * 
+         * @return u8string_view (empty if not found)
+         */
+        u8string_view get(u8string_view name) const noexcept {
+            for(auto attr : *this){
+                if(attr.name == name){
+                    return attr.value;
+                }
+            }
+            return u8string_view();
+        }
+    private:
+        const xmlChar **attrs = nullptr;
+        int n = 0;
+};
+
+namespace Detail {
+    /**
+     * @brief Append the character of a reference (the name between & and ;)
+     * 
+     * @return false if it is not a predefined or character reference
+     */
+    inline bool AppendReference(u8string &out,u8string_view ref) {
+        static const std::pair<u8string_view,char> predefined[] = {
+            {"amp",'&'},{"lt",'<'},{"gt",'>'},{"quot",'"'},{"apos",'\''}
+        };
+        for(auto &entity : predefined){
+            if(ref == entity.first){
+                out.push_back(entity.second);
+                return true;
+            }
+        }
+        if(ref.size() < 2 || ref[0] != '#'){
+            return false;
+        }
+        bool     hex = ref[1] == 'x';
+        uint32_t code = 0;
+        if(ref.size() == (hex ? 2 : 1)){
+            return false;
+        }
+        for(char c : ref.substr(hex ? 2 : 1)){
+            uint32_t digit;
+            if(c >= '0' && c <= '9'){
+                digit = c - '0';
+            }
+            else if(hex && (c | 0x20) >= 'a' && (c | 0x20) <= 'f'){
+                digit = (c | 0x20) - 'a' + 10;
+            }
+            else{
+                return false;
+            }
+            code = code * (hex ? 16 : 10) + digit;
+            if(code > 0x10FFFF){
+                return false;
+            }
+        }
+        xmlChar buf[4];
+        int     len = code == 0 ? 0 : xmlCopyCharMultiByte(buf,int(code));
+        if(len <= 0){
+            return false;
+        }
+        out.append(reinterpret_cast<const char_t *>(buf),len);
+        return true;
+    }
+    /**
+     * @brief Append the text with the predefined and character references decoded,the others are kept
+     * 
+     */
+    inline void AppendDecoded(u8string &out,u8string_view s) {
+        size_t i = 0;
+        while(i < s.size()){
+            size_t amp = s.find('&',i);
+            size_t semi = amp == u8string_view::npos ? amp : s.find(';',amp);
+            if(semi == u8string_view::npos){
+                out.append(s.data() + i,s.size() - i);
+                return;
+            }
+            out.append(s.data() + i,amp - i);
+            if(!AppendReference(out,s.substr(amp + 1,semi - amp - 1))){
+                out.append(s.data() + amp,semi + 1 - amp);
+            }
+            i = semi + 1;
+        }
+    }
+
+    template<class T,class = void>
+    struct HasStartElement : std::false_type {};
+    template<class T>
+    struct HasStartElement<T,std::void_t<decltype(
+        std::declval<T&>().on_start_element(u8string_view(),SAXAttributes())
+    )>> : std::true_type {};
+
+    template<class T,class = void>
+    struct HasEndElement : std::false_type {};
+    template<class T>
+    struct HasEndElement<T,std::void_t<decltype(
+        std::declval<T&>().on_end_element(u8string_view())
+    )>> : std::true_type {};
+
+    template<class T,class = void>
+    struct HasText : std::false_type {};
+    template<class T>
+    struct HasText<T,std::void_t<decltype(
+        std::declval<T&>().on_text(u8string_view())
+    )>> : std::true_type {};
+}
+
+/**
+ * @brief Streaming parser,it calls the Handler's members without building a DOM
+ * 
+ * @tparam Handler Could have any of
+ *  on_start_element(u8string_view name,SAXAttributes attrs)
+ *  on_end_element(u8string_view name)
+ *  on_text(u8string_view text)
+ *  Callbacks that not defined are not registered to libxml2
+ */
+template<class Handler>
+class SAXParser {
+    public:
+        SAXParser(Handler &h) : handler(&h) {}
+        SAXParser(const SAXParser &) = delete;
+        ~SAXParser() = default;
+
+        /**
+         * @brief Parse from memory
+         * 
+         * @return true on well-formed input
+         */
+        bool parse(u8string_view str,int opt = DefaultOptions) {
+            return run(xmlCreateMemoryParserCtxt(str.data(),str.size()),opt);
+        }
+        /**
+         * @brief Parse a file by streaming,the whole file is never loaded into memory
+         * 
+         * @return true on well-formed input
+         */
+        bool parse_file(const char *path,int opt = DefaultOptions) {
+            return run(xmlCreateFileParserCtxt(path),opt);
+        }
+        /**
+         * @brief Stop the parsing,could be called in the callbacks
+         * 
+         */
+        void stop() noexcept {
+            if(ctxt != nullptr){
+                xmlStopParser(ctxt);
+            }
+        }
+
+        static xmlSAXHandler Callbacks() noexcept {
+            xmlSAXHandler sax{};
+            sax.initialized = XML_SAX2_MAGIC;
+            //Keep the DTD part of the default SAX2 handler,so the entities still work
+            sax.startDocument = xmlSAX2StartDocument;
+            sax.internalSubset = xmlSAX2InternalSubset;
+            sax.entityDecl = xmlSAX2EntityDecl;
+            sax.getEntity = xmlSAX2GetEntity;
+            sax.getParameterEntity = xmlSAX2GetParameterEntity;
+            if constexpr(Detail::HasStartElement<Handler>::value){
+                sax.startElementNs = OnStartElement;
+            }
+            if constexpr(Detail::HasEndElement<Handler>::value){
+                sax.endElementNs = OnEndElement;
+            }
+            if constexpr(Detail::HasText<Handler>::value){
+                sax.characters = OnText;
+                sax.ignorableWhitespace = OnText;
+                sax.cdataBlock = OnText;
+            }
+            return sax;
+        }
+    private:
+        bool run(xmlParserCtxtPtr c,int opt) {
+            if(c == nullptr){
+                return false;
+            }
+            static const xmlSAXHandler sax = Callbacks();
+            *c->sax = sax;
+            //userData stays the ctxt for the xmlSAX2 callbacks
+            c->_private = this;
+            xmlCtxtUseOptions(c,opt);
+
+            ctxt = c;
+            xmlParseDocument(c);
+            ctxt = nullptr;
+
+            bool ok = c->wellFormed;
+            if(c->myDoc != nullptr){
+                xmlFreeDoc(c->myDoc);
+            }
+            xmlFreeParserCtxt(c);
+            return ok;
+        }
+        static SAXParser *GetParser(void *ctx) noexcept {
+            return static_cast<SAXParser*>(static_cast<xmlParserCtxtPtr>(ctx)->_private);
+        }
+        static Handler *GetHandler(void *ctx) noexcept {
+            return GetParser(ctx)->handler;
+        }
+        /**
+         * @brief Decode the references of the values into the scratch buffer,if any
+         * 
+         * libxml2 keeps them in the value slices (& is passed as &#38;) unless NoEntities is set
+         */
+        const xmlChar **decode(const xmlChar **attributes,int n) {
+            if(ctxt->replaceEntities){
+                //Decoded already,a & in the value is literal
+                return attributes;
+            }
+            bool found = false;
+            for(int i = 0;i < n && !found;i++){
+                const xmlChar *value = attributes[i * 5 + 3];
+                found = std::memchr(value,'&',attributes[i * 5 + 4] - value) != nullptr;
+            }
+            if(!found){
+                return attributes;
+            }
+            scratch_text.clear();
+            scratch_ends.clear();
+            for(int i = 0;i < n;i++){
+                const xmlChar *value = attributes[i * 5 + 3];
+                Detail::AppendDecoded(
+                    scratch_text,
+                    u8string_view(reinterpret_cast<const char_t *>(value),attributes[i * 5 + 4] - value)
+                );
+                scratch_ends.push_back(scratch_text.size());
+            }
+            //The text is complete,it would not move anymore
+            scratch_attrs.assign(attributes,attributes + n * 5);
+            auto   base = reinterpret_cast<const xmlChar *>(scratch_text.data());
+            size_t begin = 0;
+            for(int i = 0;i < n;i++){
+                scratch_attrs[i * 5 + 3] = base + begin;
+                scratch_attrs[i * 5 + 4] = base + scratch_ends[i];
+                begin = scratch_ends[i];
+            }
+            return scratch_attrs.data();
+        }
+        static void OnStartElement(void *ctx,
+                                   const xmlChar *localname,
+                                   const xmlChar *,
+                                   const xmlChar *,
+                                   int,
+                                   const xmlChar **,
+                                   int nb_attributes,
+                                   int,
+                                   const xmlChar **attributes) {
+            auto parser = GetParser(ctx);
+            parser->handler->on_start_element(
+                ToView(localname),
+                SAXAttributes(parser->decode(attributes,nb_attributes),nb_attributes)
+            );
+        }
+        static void OnEndElement(void *ctx,
+                                 const xmlChar *localname,
+                                 const xmlChar *,
+                                 const xmlChar *) {
+            GetHandler(ctx)->on_end_element(ToView(localname));
+        }
+        static void OnText(void *ctx,const xmlChar *ch,int len) {
+            GetHandler(ctx)->on_text(
+                u8string_view(reinterpret_cast<const char_t *>(ch),len)
+            );
+        }
+
+        Handler         *handler = nullptr;
+        xmlParserCtxtPtr ctxt = nullptr;
+        //Decoded attribute values of the current start element
+        std::vector<const xmlChar *> scratch_attrs;
+        std::vector<size_t>          scratch_ends;
+        u8string                     scratch_text;
+};
+
+LXML_NS_END
+
+
+//--XmlReader
+LXML_NS_BEGIN
+class XmlReader;
+/**
+ * @brief Input iterator of XmlReader,it derefs to the reader itself
+ * 
+ */
+class XmlReaderIterator {
+    public:
+        XmlReaderIterator() = default;
+        XmlReaderIterator(XmlReader *reader) : reader(reader) {}
+
+        bool operator ==(const XmlReaderIterator &iter) const noexcept {
+            return reader == iter.reader;
+        }
+        bool operator !=(const XmlReaderIterator &iter) const noexcept {
+            return reader != iter.reader;
+        }
+        XmlReaderIterator &operator ++();
+        XmlReader &operator *() const noexcept {
+            return *reader;
+        }
+        XmlReader *operator ->() const noexcept {
+            return reader;
+        }
+    private:
+        XmlReader *reader = nullptr;
+};
+/**
+ * @brief Pull parser,walk the input node by node with constant memory
+ * 
+ */
+class XmlReader {
+    public:
+        using iterator = XmlReaderIterator;
+
+        XmlReader() = default;
+        XmlReader(const XmlReader &) = delete;
+        XmlReader(XmlReader &&other) : reader(other.reader), skip(other.skip), status(other.status) {
+            other.reader = nullptr;
+        }
+        ~XmlReader() {
+            xmlFreeTextReader(reader);
+        }
+
+        explicit XmlReader(xmlTextReaderPtr p) : reader(p) {}
+
+        XmlReader &operator =(XmlReader &&other) {
+            if(this != &other){
+                xmlFreeTextReader(reader);
+                reader = other.reader;
+                skip = other.skip;
+                status = other.status;
+                other.reader = nullptr;
+            }
+            return *this;
+        }
+    public:
+        /**
+         * @brief Move to the next node in document order
+         * 
+         * @note If the current node was expanded,its subtree is skipped and freed
+         * @return true on success,false on end or error
+         */
+        bool read() {
+            if(skip){
+                skip = false;
+                status = xmlTextReaderNext(reader);
+            }
+            else{
+                status = xmlTextReaderRead(reader);
+            }
+            return status == 1;
+        }
+        /**
+         * @brief Skip the subtree of the current node,move to the next sibling
+         * 
+         */
+        bool next() {
+            skip = false;
+            status = xmlTextReaderNext(reader);
+            return status == 1;
+        }
+        /**
+         * @brief Move to the next start tag of the element
+         * 
+         * @param name The local name of the element
+         */
+        bool next_element(u8string_view name) {
+            while(read()){
+                if(is_element() && name_view() == name){
+                    return true;
+                }
+            }
+            return false;
+        }
+        /**
+         * @brief Build the subtree of the current node
+         * 
+         * @note The subtree is owned by the reader,and freed once the reader moves past it
+         * @return NodeRef (null on error)
+         */
+        NodeRef expand() {
+            xmlNodePtr node = xmlTextReaderExpand(reader);
+            skip = (node != nullptr);
+            return NodeRef(node);
+        }
+        bool has_error() const noexcept {
+            return status == -1;
+        }
+        //--Current node
+        int node_type() const {
+            return xmlTextReaderNodeType(reader);
+        }
+        bool is_element() const {
+            return node_type() == XML_READER_TYPE_ELEMENT;
+        }
+        bool is_end_element() const {
+            return node_type() == XML_READER_TYPE_END_ELEMENT;
+        }
+        bool is_text() const {
+            int type = node_type();
+            return type == XML_READER_TYPE_TEXT || type == XML_READER_TYPE_CDATA;
+        }
+        bool is_empty_element() const {
+            return xmlTextReaderIsEmptyElement(reader) == 1;
+        }
+        int depth() const {
+            return xmlTextReaderDepth(reader);
+        }
+        /**
+         * @brief Get the local name,it keeps valid until the reader is freed
+         * 
+         */
+        u8string_view name_view() const {
+            return ToView(xmlTextReaderConstLocalName(reader));
+        }
+        /**
+         * @brief Get the qualified name,it keeps valid until the reader is freed
+         * 
+         */
+        u8string_view qname_view() const {
+            return ToView(xmlTextReaderConstName(reader));
+        }
+        /**
+         * @brief Get the text value,it keeps valid until the next read
+         * 
+         */
+        u8string_view value_view() const {
+            return ToView(xmlTextReaderConstValue(reader));
+        }
+        /**
+         * @brief Get the attribute of the current element by its qualified name
+         * 
+         * @note libxml2 wants a NUL terminated name,the view is copied first
+         */
+        lstring attribute(u8string_view name) const {
+            u8string cname(name);
+            return lstring(xmlTextReaderGetAttribute(reader,BAD_CAST cname.c_str()));
+        }
+        //--Iterate
+        iterator begin() {
+            return read() ? iterator(this) : iterator();
+        }
+        iterator end() {
+            return iterator();
+        }
+
+        xmlTextReaderPtr get() const noexcept {
+            return reader;
+        }
+        /**
+         * @brief Read from a string,it is not copied and must outlive the reader
+         * 
+         */
+        static XmlReader Parse(u8string_view str,int opt = DefaultOptions);
+        static XmlReader ParseFile(const char *path,int opt = DefaultOptions);
+    private:
+        xmlTextReaderPtr reader = nullptr;
+        bool             skip = false;
+        int              status = 0;
+};
+
+inline XmlReaderIterator &XmlReaderIterator::operator ++() {
+    if(!reader->read()){
+        reader = nullptr;
+    }
+    return *this;
+}
+inline XmlReader XmlReader::Parse(u8string_view str,int opt) {
+    xmlTextReaderPtr reader = xmlReaderForMemory(str.data(),str.size(),"","UTF-8",opt);
+#ifndef LXML_NO_EXCEPTIONS
+    if(reader == nullptr){
+        LXML_THROW(std::runtime_error("Failed to create xml reader"));
+    }
+#endif
+    return XmlReader(reader);
+}
+inline XmlReader XmlReader::ParseFile(const char *path,int opt) {
+    xmlTextReaderPtr reader = xmlReaderForFile(path,nullptr,opt);
+#ifndef LXML_NO_EXCEPTIONS
+    if(reader == nullptr){
+        LXML_THROW(std::runtime_error("Failed to create xml reader"));
+    }
+#endif
+    return XmlReader(reader);
+}
+
+LXML_NS_END
+
+//--Binding
+LXML_NS_BEGIN
+namespace Detail {
+    enum class BindKind {
+        Attribute,
+        Element,
+        Text,
+    };
+}
+/**
+ * @brief Field of a binding descriptor,made by BindAttribute() / BindElement() / BindText()
+ * 
+ */
+template<Detail::BindKind Kind,class T,class M>
+struct BindField {
+    static constexpr Detail::BindKind kind = Kind;
+
+    u8string_view name;
+    M T::*member;
+};
+/**
+ * @brief Map the attribute to the member
+ * 
+ */
+template<class T,class M>
+constexpr BindField<Detail::BindKind::Attribute,T,M> BindAttribute(u8string_view name,M T::*member) {
+    return {name,member};
+}
+/**
+ * @brief Map the child element to the member,a std::vector member gets all the child elements with the name
+ *        and a member with its own binding is bound recursively
+ * 
+ */
+template<class T,class M>
+constexpr BindField<Detail::BindKind::Element,T,M> BindElement(u8string_view name,M T::*member) {
+    return {name,member};
+}
+/**
+ * @brief Map the text of the element itself to the member
+ * 
+ */
+template<class T,class M>
+constexpr BindField<Detail::BindKind::Text,T,M> BindText(M T::*member) {
+    return {u8string_view(),member};
+}
+/**
+ * @brief Make the binding descriptor of a struct,declare it as static constexpr member lxml_binding
+ * 
+ * @code
+ *  struct Book {
+ *      int         id;
+ *      std::string title;
+ *      double      price;
+ *
+ *      static constexpr auto lxml_binding = LXml::Binding(
+ *          LXml::BindAttribute("id",&Book::id),
+ *          LXml::BindElement("title",&Book::title),
+ *          LXml::BindElement("price",&Book::price)
+ *      );
+ *  };
+ * @endcode
+ */
+template<class ...Fields>
+constexpr std::tuple<Fields...> Binding(Fields ...fields) {
+    return std::tuple<Fields...>(fields...);
+}
+
+namespace Detail {
+    template<class T,class = void>
+    struct HasBinding : std::false_type {};
+    template<class T>
+    struct HasBinding<T,std::void_t<decltype(T::lxml_binding)>> : std::true_type {};
+
+    template<class T>
+    struct IsVector : std::false_type {};
+    template<class T,class Alloc>
+    struct IsVector<std::vector<T,Alloc>> : std::true_type {};
+
+    template<class T>
+    struct AlwaysFalse : std::false_type {};
+
+    template<class Tuple,class Fn,size_t ...I>
+    void ForEachField(const Tuple &fields,Fn &&fn,std::index_sequence<I...>) {
+        (fn(std::get<I>(fields),std::integral_constant<size_t,I>()),...);
+    }
+    template<class Tuple,class Fn>
+    void ForEachField(const Tuple &fields,Fn &&fn) {
+        ForEachField(fields,fn,std::make_index_sequence<std::tuple_size<Tuple>::value>());
+    }
+    template<BindKind Kind,class ...Fields>
+    constexpr bool HasFieldKind(const std::tuple<Fields...> *) {
+        return ((Fields::kind == Kind) || ...);
+    }
+
+    inline bool IsXmlSpace(char c) noexcept {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+    inline u8string_view TrimView(u8string_view s) noexcept {
+        while(!s.empty() && IsXmlSpace(s.front())){
+            s.remove_prefix(1);
+        }
+        while(!s.empty() && IsXmlSpace(s.back())){
+            s.remove_suffix(1);
+        }
+        return s;
+    }
+    /**
+     * @brief Convert the text in place,numbers by from_chars
+     * 
+     * @return false on a malformed number
+     */
+    template<class V>
+    bool FromView(u8string_view s,V &out) {
+        if constexpr(std::is_same<V,bool>::value){
+            s = TrimView(s);
+            if(s == "true" || s == "1"){
+                out = true;
+                return true;
+            }
+            if(s == "false" || s == "0"){
+                out = false;
+                return true;
+            }
+            return false;
+        }
+        else if constexpr(std::is_arithmetic<V>::value){
+            s = TrimView(s);
+            auto end = s.data() + s.size();
+            auto ret = std::from_chars(s.data(),end,out);
+            return ret.ec == std::errc() && ret.ptr == end;
+        }
+        else if constexpr(std::is_same<V,u8string_view>::value || std::is_pointer<V>::value){
+            //The text may live in a temporary copy (entities,mixed content),it can't be borrowed
+            static_assert(AlwaysFalse<V>::value,"Bind a string member,views of the text could dangle");
+            return false;
+        }
+        else if constexpr(std::is_assignable<V&,u8string_view>::value){
+            out = s;
+            return true;
+        }
+        else{
+            static_assert(AlwaysFalse<V>::value,"No conversion from text to the member type");
+            return false;
+        }
+    }
+    //Text of the element,borrowed if it is a single text node,else copied into storage
+    inline u8string_view ElementText(const xmlNode *node,lstring &storage) {
+        const xmlNode *child = node->children;
+        if(child == nullptr){
+            return u8string_view();
+        }
+        if(child->next == nullptr && (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE)){
+            return ToView(child->content);
+        }
+        storage = lstring(xmlNodeGetContent(node));
+        return storage.view();
+    }
+
+    template<class T>
+    bool BindNode(const xmlNode *node,T &out);
+
+    template<class M>
+    bool BindValue(const xmlNode *node,M &out) {
+        if constexpr(HasBinding<M>::value){
+            return BindNode(node,out);
+        }
+        else{
+            lstring storage;
+            return FromView(ElementText(node,storage),out);
+        }
+    }
+    template<class T>
+    bool BindNode(const xmlNode *node,T &out) {
+        using Fields = std::decay_t<decltype(T::lxml_binding)>;
+        constexpr const Fields *tag = nullptr;
+        const Fields &fields = T::lxml_binding;
+        //Scalar members take the first match
+        bool seen[std::tuple_size<Fields>::value + 1] = {};
+        bool ok = true;
+
+        if constexpr(HasFieldKind<BindKind::Attribute>(tag)){
+            for(const xmlAttr *attr = node->properties;attr != nullptr;attr = attr->next){
+                ForEachField(fields,[&](auto &field,auto index){
+                    if constexpr(std::decay_t<decltype(field)>::kind == BindKind::Attribute){
+                        if(seen[index] || !NameEquals(attr->name,field.name)){
+                            return;
+                        }
+                        seen[index] = true;
+                        u8string_view value;
+                        if(AttributeView(attr,value)){
+                            ok &= FromView(value,out.*field.member);
+                        }
+                        else{
+                            lstring storage(xmlNodeListGetString(node->doc,attr->children,1));
+                            ok &= FromView(storage.view(),out.*field.member);
+                        }
+                    }
+                });
+            }
+        }
+        if constexpr(HasFieldKind<BindKind::Element>(tag)){
+            for(const xmlNode *child = node->children;child != nullptr;child = child->next){
+                if(child->type != XML_ELEMENT_NODE){
+                    continue;
+                }
+                ForEachField(fields,[&](auto &field,auto index){
+                    if constexpr(std::decay_t<decltype(field)>::kind == BindKind::Element){
+                        using Member = std::decay_t<decltype(out.*field.member)>;
+                        if(!NameEquals(child->name,field.name)){
+                            return;
+                        }
+                        if constexpr(IsVector<Member>::value){
+                            auto &vec = out.*field.member;
+                            vec.emplace_back();
+                            ok &= BindValue(child,vec.back());
+                        }
+                        else if(!seen[index]){
+                            seen[index] = true;
+                            ok &= BindValue(child,out.*field.member);
+                        }
+                    }
+                });
+            }
+        }
+        if constexpr(HasFieldKind<BindKind::Text>(tag)){
+            ForEachField(fields,[&](auto &field,auto){
+                if constexpr(std::decay_t<decltype(field)>::kind == BindKind::Text){
+                    lstring storage;
+                    ok &= FromView(ElementText(node,storage),out.*field.member);
+                }
+            });
+        }
+        return ok;
+    }
+}
+
+/**
+ * @brief Fill the struct from the element by its lxml_binding descriptor,no intermediate strings for numbers
+ * 
+ * @note Missing attributes / elements keep the member untouched,a malformed value keeps it too.
+ *       The members must own their text (u8string),views are rejected at compile time
+ * @return false on null node or a malformed value
+ */
+template<class T>
+bool Bind(NodeRef node,T &out) {
+    static_assert(Detail::HasBinding<T>::value,"T needs a static constexpr lxml_binding descriptor");
+    if(node.is_null()){
+        return false;
+    }
+    return Detail::BindNode(node.get(),out);
+}
+/**
+ * @brief Bind into a value initialized T
+ * 
+ * @note The errors are ignored,use Bind(node,out) to check them
+ */
+template<class T>
+T Bind(NodeRef node) {
+    T out {};
+    Bind(node,out);
+    return out;
+}
+/**
+ * @brief Bind every element with the name while streaming,the subtree is freed after fn
+ * 
+ * @param fn fn(T &&) or fn(T &&,bool ok),ok is the result of Bind(),false on a malformed value
+ * @return The number of the bound elements
+ */
+template<class T,class Fn>
+size_t BindEach(XmlReader &reader,u8string_view name,Fn &&fn) {
+    size_t n = 0;
+    while(reader.next_element(name)){
+        NodeRef node = reader.expand();
+        if(node.is_null()){
+            break;
+        }
+        T value {};
+        bool ok = Bind(node,value);
+        if constexpr(std::is_invocable<Fn,T&&,bool>::value){
+            fn(std::move(value),ok);
+        }
+        else{
+            fn(std::move(value));
+        }
+        n++;
+    }
+    return n;
+}
+
+LXML_NS_END
+
+//--XmlWriter
+LXML_NS_BEGIN
+namespace Detail {
+    inline unsigned CountTrailingZeros(uint64_t v) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(v);
+#else
+        unsigned n = 0;
+        while((v & 1) == 0){
+            v >>= 1;
+            n++;
+        }
+        return n;
+#endif
+    }
+    /**
+     * @brief Escape tables,0 on copied as is,else the index in EscapeEntity()
+     * 
+     */
+    struct EscapeTables {
+        uint8_t text[256] = {};
+        uint8_t attribute[256] = {};
+
+        EscapeTables() {
+            text['&'] = attribute['&'] = 1;
+            text['<'] = attribute['<'] = 2;
+            text['>'] = attribute['>'] = 3;
+            text['\r'] = attribute['\r'] = 7;
+            attribute['"'] = 4;
+            attribute['\t'] = 5;
+            attribute['\n'] = 6;
+        }
+    };
+    inline const EscapeTables &GetEscapeTables() noexcept {
+        static const EscapeTables tables;
+        return tables;
+    }
+    inline u8string_view EscapeEntity(uint8_t index) noexcept {
+        static const u8string_view entities[] = {
+            "","&amp;","&lt;","&gt;","&quot;","&#9;","&#10;","&#13;"
+        };
+        return entities[index];
+    }
+    /**
+     * @brief Get the length of the prefix with nothing to escape
+     * 
+     */
+    inline size_t EscapeSpan(const char *p,size_t n,const uint8_t *table) noexcept {
+        size_t i = 0;
+#if LXML_SIMD_X86
+        //Candidates: & < > " and the control bytes,the table decides
+        const __m128i amp = _mm_set1_epi8('&');
+        const __m128i two = _mm_set1_epi8(2);
+        const __m128i gt = _mm_set1_epi8('>');
+        const __m128i quot = _mm_set1_epi8('"');
+        const __m128i ctrl = _mm_set1_epi8(0x1F);
+        for(;i + 16 <= n;i += 16){
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            __m128i m = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v,amp),_mm_cmpeq_epi8(_mm_or_si128(v,two),gt)),
+                _mm_or_si128(_mm_cmpeq_epi8(v,quot),_mm_cmpeq_epi8(_mm_max_epu8(v,ctrl),ctrl))
+            );
+            unsigned mask = unsigned(_mm_movemask_epi8(m));
+            while(mask != 0){
+                size_t j = i + CountTrailingZeros(mask);
+                if(table[uint8_t(p[j])] != 0){
+                    return j;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for(;i < n;i++){
+            if(table[uint8_t(p[i])] != 0){
+                return i;
+            }
+        }
+        return n;
+    }
+}
+/**
+ * @brief Streaming xml writer without DOM,the output goes through a fixed size buffer to the sink
+ * 
+ * @note Names are written as is,the caller must pass valid xml names
+ * 
+ * @code
+ *  LXml::XmlWriter writer(LXml::OutputSink(fd));
+ *  writer.start_document();
+ *  writer.start_element("rows");
+ *  writer.start_element("row");
+ *  writer.attribute("id",1);
+ *  writer.text("a < b");
+ *  writer.end_document();
+ * @endcode
+ */
+class XmlWriter {
+    public:
+        explicit XmlWriter(OutputSink sink,size_t buffer_size = LXML_WRITER_BUFFER_SIZE) :
+            sink(std::move(sink)),
+            buffer(new char[buffer_size == 0 ? 1 : buffer_size]),
+            capacity(buffer_size == 0 ? 1 : buffer_size) {}
+        XmlWriter(const XmlWriter &) = delete;
+        ~XmlWriter() {
+            flush();
+        }
+    public:
+        /**
+         * @brief Write the xml declaration
+         * 
+         */
+        void start_document(u8string_view version = "1.0",u8string_view encoding = "UTF-8") {
+            append("<?xml version=\"");
+            append(version);
+            if(!encoding.empty()){
+                append("\" encoding=\"");
+                append(encoding);
+            }
+            append("\"?>\n");
+        }
+        /**
+         * @brief Close all the open elements and flush the output
+         * 
+         * @return false on write error
+         */
+        bool end_document() {
+            while(!offsets.empty()){
+                end_element();
+            }
+            return flush();
+        }
+        void start_element(u8string_view name) {
+            close_start_tag();
+            append('<');
+            append(name);
+            offsets.push_back(names.size());
+            names.append(name.data(),name.size());
+            in_start_tag = true;
+        }
+        /**
+         * @brief Close the current element,an element without content is written as <name/>
+         * 
+         */
+        void end_element() {
+            if(offsets.empty()){
+                return;
+            }
+            size_t offset = offsets.back();
+            if(in_start_tag){
+                append("/>");
+                in_start_tag = false;
+            }
+            else{
+                append("</");
+                append(u8string_view(names.data() + offset,names.size() - offset));
+                append('>');
+            }
+            offsets.pop_back();
+            names.resize(offset);
+        }
+        /**
+         * @brief Add an attribute to the current start tag,the value is escaped
+         * 
+         */
+        void attribute(u8string_view name,u8string_view value) {
+            if(!in_start_tag){
+                return;
+            }
+            append(' ');
+            append(name);
+            append("=\"");
+            escape(value,Detail::GetEscapeTables().attribute);
+            append('"');
+        }
+        /**
+         * @brief Write the escaped text
+         * 
+         */
+        void text(u8string_view s) {
+            close_start_tag();
+            escape(s,Detail::GetEscapeTables().text);
+        }
+        //--Numbers by to_chars,bool as true / false
+        template<class V,class = std::enable_if_t<std::is_arithmetic<V>::value>>
+        void attribute(u8string_view name,V value) {
+            char buf[64];
+            attribute(name,Format(buf,value));
+        }
+        template<class V,class = std::enable_if_t<std::is_arithmetic<V>::value>>
+        void text(V value) {
+            char buf[64];
+            text(Format(buf,value));
+        }
+        /**
+         * @brief Write <name>text</name>
+         * 
+         */
+        void element(u8string_view name,u8string_view s) {
+            start_element(name);
+            text(s);
+            end_element();
+        }
+        /**
+         * @brief Write a CDATA section,"]]>" in it is split into two sections
+         * 
+         */
+        void cdata(u8string_view s) {
+            close_start_tag();
+            append("<![CDATA[");
+            for(size_t pos = s.find("]]>");pos != u8string_view::npos;pos = s.find("]]>")){
+                append(s.substr(0,pos + 2));
+                append("]]><![CDATA[");
+                s.remove_prefix(pos + 2);
+            }
+            append(s);
+            append("]]>");
+        }
+        void comment(u8string_view s) {
+            close_start_tag();
+            append("<!--");
+            append(s);
+            append("-->");
+        }
+        /**
+         * @brief Write the data without escape
+         * 
+         */
+        void raw(u8string_view s) {
+            close_start_tag();
+            append(s);
+        }
+        /**
+         * @brief Send the buffered data to the sink
+         * 
+         * @return false on write error (now or before)
+         */
+        bool flush() {
+            flush_buffer();
+            if(!sink.flush()){
+                failed = true;
+            }
+            return !failed;
+        }
+        /**
+         * @brief Write to a new sink,the buffer is kept for reuse
+         * 
+         */
+        void reset(OutputSink s) {
+            flush();
+            sink = std::move(s);
+            names.clear();
+            offsets.clear();
+            in_start_tag = false;
+            failed = false;
+            written = 0;
+        }
+        size_t depth() const noexcept {
+            return offsets.size();
+        }
+        /**
+         * @brief Get the number of bytes sent to the sink
+         * 
+         */
+        size_t bytes_written() const noexcept {
+            return written;
+        }
+        bool good() const noexcept {
+            return !failed;
+        }
+    private:
+        template<class V>
+        static u8string_view Format(char (&buf)[64],V value) {
+            if constexpr(std::is_same<V,bool>::value){
+                return value ? "true" : "false";
+            }
+            else{
+                auto ret = std::to_chars(buf,buf + sizeof(buf),value);
+                return u8string_view(buf,ret.ptr - buf);
+            }
+        }
+        void close_start_tag() {
+            if(in_start_tag){
+                append('>');
+                in_start_tag = false;
+            }
+        }
+        void escape(u8string_view s,const uint8_t *table) {
+            while(!s.empty()){
+                size_t span = Detail::EscapeSpan(s.data(),s.size(),table);
+                append(s.data(),span);
+                if(span == s.size()){
+                    break;
+                }
+                append(Detail::EscapeEntity(table[uint8_t(s[span])]));
+                s.remove_prefix(span + 1);
+            }
+        }
+        void append(char c) {
+            if(size == capacity){
+                flush_buffer();
+            }
+            buffer[size++] = c;
+        }
+        void append(u8string_view s) {
+            append(s.data(),s.size());
+        }
+        void append(const char *data,size_t n) {
+            if(size + n > capacity){
+                flush_buffer();
+                if(n >= capacity){
+                    //Too big for the buffer,send it directly
+                    write_sink(data,n);
+                    return;
+                }
+            }
+            std::memcpy(buffer.get() + size,data,n);
+            size += n;
+        }
+        void flush_buffer() {
+            if(size != 0){
+                write_sink(buffer.get(),size);
+                size = 0;
+            }
+        }
+        void write_sink(const char *data,size_t n) {
+            if(failed){
+                return;
+            }
+            if(!sink.write(data,n)){
+                failed = true;
+                return;
+            }
+            written += n;
+        }
+
+        OutputSink              sink;
+        std::unique_ptr<char[]> buffer;
+        size_t                  size = 0;
+        size_t                  capacity;
+        u8string                names;//< Names of the open elements,concatenated
+        std::vector<size_t>     offsets;
+        size_t                  written = 0;
+        bool                    in_start_tag = false;
+        bool                    failed = false;
+};
+
+LXML_NS_END
+
+
+//--Arena
+LXML_NS_BEGIN
+/**
+ * @brief Bump allocator for libxml2,all the memory is released at once when it is destroyed
+ * 
+ * @note It works only after Arena::Install() was called,before any other libxml2 call.
+ *       The arena has no lock: a block is always reallocated and freed by the arena that made it,
+ *       whatever thread frees it,so the arena and its documents must stay on one thread
+ */
+class Arena {
+    public:
+        Arena(size_t block_size = LXML_ARENA_BLOCK_SIZE) : block_size(block_size) {}
+        Arena(const Arena &) = delete;
+        ~Arena() {
+            release();
+        }
+    public:
+        /**
+         * @brief Allocate n bytes,the result is aligned to 16 bytes
+         * 
+         */
+        void *allocate(size_t n) {
+            size_t need = Align(n) + sizeof(Header);
+            char  *p;
+            if(need > block_size / 4){
+                //Large allocation,give it a dedicated block
+                p = new_block(need,large);
+                if(p == nullptr){
+                    return nullptr;
+                }
+            }
+            else{
+                if(head == nullptr || size_t(head->end - cur) < need){
+                    char *begin = new_block(block_size,head);
+                    if(begin == nullptr){
+                        return nullptr;
+                    }
+                    cur = begin;
+                }
+                p = cur;
+                last = cur;
+                cur += need;
+            }
+            Header *h = reinterpret_cast<Header*>(p);
+            h->size = n;
+            h->owner = this;
+            used += need;
+            return h + 1;
+        }
+        /**
+         * @brief Resize the block,it grows in place if it is the last allocation
+         * 
+         */
+        void *reallocate(void *p,size_t n) {
+            Header *h = static_cast<Header*>(p) - 1;
+            if(reinterpret_cast<char*>(h) == last){
+                size_t need = Align(n) + sizeof(Header);
+                if(size_t(head->end - last) >= need){
+                    used += need - size_t(cur - last);
+                    cur = last + need;
+                    h->size = n;
+                    return p;
+                }
+            }
+            void *np = allocate(n);
+            if(np == nullptr){
+                return nullptr;
+            }
+            std::memcpy(np,p,h->size < n ? h->size : n);
+            deallocate(p);
+            return np;
+        }
+        /**
+         * @brief Free the block,only the last allocation is reclaimed
+         * 
+         */
+        void deallocate(void *p) noexcept {
+            char *h = reinterpret_cast<char*>(static_cast<Header*>(p) - 1);
+            if(h == last){
+                used -= size_t(cur - last);
+                cur = last;
+                last = nullptr;
+            }
+        }
+        /**
+         * @brief Release all the blocks
+         * 
+         */
+        void release() noexcept {
+            for(Block *list : {head,large}){
+                while(list != nullptr){
+                    Block *next = list->next;
+                    std::free(list);
+                    list = next;
+                }
+            }
+            head = nullptr;
+            large = nullptr;
+            cur = nullptr;
+            last = nullptr;
+            used = 0;
+            reserved = 0;
+        }
+        size_t used_bytes() const noexcept {
+            return used;
+        }
+        size_t reserved_bytes() const noexcept {
+            return reserved;
+        }
+        /**
+         * @brief Route the libxml2 allocator through the arena of current thread
+         * 
+         * @note Must be called before any other libxml2 call,the memory allocated before is not known by it
+         * @return true on success
+         */
+        static bool Install() {
+            if(Installed()){
+                return true;
+            }
+            xmlMemGet(&Fallback().free,&Fallback().malloc,&Fallback().realloc,&Fallback().strdup);
+            if(xmlMemSetup(Free,Malloc,Realloc,Strdup) != 0){
+                return false;
+            }
+            Installed() = true;
+            return true;
+        }
+        static bool &Installed() noexcept {
+            static bool installed = false;
+            return installed;
+        }
+        /**
+         * @brief Get the active arena of current thread
+         * 
+         * @return Arena* (nullptr on none)
+         */
+        static Arena *&Current() noexcept {
+            thread_local Arena *arena = nullptr;
+            return arena;
+        }
+    private:
+        struct Header {
+            size_t size;
+            Arena *owner;//< nullptr on heap
+        };
+        struct Block {
+            Block *next;
+            char  *end;
+        };
+        struct Functions {
+            xmlFreeFunc    free;
+            xmlMallocFunc  malloc;
+            xmlReallocFunc realloc;
+            xmlStrdupFunc  strdup;
+        };
+        static_assert(sizeof(Header) == 16 && sizeof(Block) == 16,"Arena needs 16 bytes headers");
+
+        static size_t Align(size_t n) noexcept {
+            return (n + 15) & ~size_t(15);
+        }
+        char *new_block(size_t size,Block *&list) {
+            //Never throw here,it is called from libxml2
+            Block *block = static_cast<Block*>(std::malloc(sizeof(Block) + size));
+            if(block == nullptr){
+                return nullptr;
+            }
+            char *begin = reinterpret_cast<char*>(block + 1);
+            block->next = list;
+            block->end = begin + size;
+            list = block;
+            reserved += size;
+            return begin;
+        }
+
+        static Functions &Fallback() noexcept {
+            static Functions functions;
+            return functions;
+        }
+        static void *Malloc(size_t n) {
+            if(Arena *arena = Current()){
+                return arena->allocate(n);
+            }
+            Header *h = static_cast<Header*>(Fallback().malloc(n + sizeof(Header)));
+            if(h == nullptr){
+                return nullptr;
+            }
+            h->size = n;
+            h->owner = nullptr;
+            return h + 1;
+        }
+        static void *Realloc(void *p,size_t n) {
+            if(p == nullptr){
+                return Malloc(n);
+            }
+            Header *h = static_cast<Header*>(p) - 1;
+            if(h->owner != nullptr){
+                //Keep the block in the arena that owns it
+                return h->owner->reallocate(p,n);
+            }
+            h = static_cast<Header*>(Fallback().realloc(h,n + sizeof(Header)));
+            if(h == nullptr){
+                return nullptr;
+            }
+            h->size = n;
+            return h + 1;
+        }
+        static void Free(void *p) {
+            if(p == nullptr){
+                return;
+            }
+            Header *h = static_cast<Header*>(p) - 1;
+            if(h->owner != nullptr){
+                h->owner->deallocate(p);
+                return;
+            }
+            Fallback().free(h);
+        }
+        static char *Strdup(const char *s) {
+            size_t n = std::strlen(s) + 1;
+            void  *p = Malloc(n);
+            if(p != nullptr){
+                std::memcpy(p,s,n);
+            }
+            return static_cast<char*>(p);
+        }
+
+        Block *head = nullptr;//< Current block for bumping
+        Block *large = nullptr;//< Dedicated blocks
+        char  *cur = nullptr;
+        char  *last = nullptr;//< The last allocation in head
+        size_t block_size;
+        size_t used = 0;
+        size_t reserved = 0;
+};
+/**
+ * @brief Make the arena active on current thread in the scope
+ * 
+ */
+class ArenaScope {
+    public:
+        ArenaScope(Arena &arena) : prev(Arena::Current()) {
+            Arena::Current() = &arena;
+        }
+        ArenaScope(const ArenaScope &) = delete;
+        ~ArenaScope() {
+            Arena::Current() = prev;
+        }
+    private:
+        Arena *prev;
+};
+/**
+ * @brief Document that takes all its memory from its own arena,destroying it just releases the blocks
+ * 
+ * The document is a private base,so it can't be moved into a plain document (xmlFreeDoc on the arena),
+ * use ref() to pass it where a DocumentRef is expected.
+ * 
+ * @tparam T XmlDocument or HtmlDocument
+ * @note Modify it inside scope(),the memory allocated outside is not freed with it.
+ *       Do not run XPath inside scope(),the cached contexts and expressions must stay on the heap.
+ *       Do not pass it to another thread,freeing or reallocating its nodes there races with the arena.
+ */
+template<class T>
+class ArenaDocument : private T {
+    public:
+        using T::root_node;
+        using T::clone;
+        using T::intern;
+        using T::freeze;
+        using T::set_root;
+        using T::to_string;
+        using T::write_to;
+        using T::version;
+        using T::get;
+
+        ArenaDocument() = default;
+        ArenaDocument(ArenaDocument &&) = default;
+        ~ArenaDocument() {
+            if(arena != nullptr && Arena::Installed()){
+                //Everything is in the arena,skip walking the tree
+                this->detach();
+            }
+        }
+
+        ArenaDocument &operator =(ArenaDocument &&other) {
+            if(this != &other){
+                ArenaDocument tmp(std::move(*this));
+                T::assign(std::move(other));
+                arena = std::move(other.arena);
+            }
+            return *this;
+        }
+
+        DocumentRef ref() const noexcept {
+            return DocumentRef(get());
+        }
+        Arena *get_arena() const noexcept {
+            return arena.get();
+        }
+        /**
+         * @brief Make the arena of the document active,for modifying it
+         * 
+         */
+        ArenaScope scope() const {
+            return ArenaScope(*arena);
+        }
+
+        static ArenaDocument Parse(u8string_view str,int opt = DefaultOptions) {
+            return Create([&](){
+                return T::Parse(str,opt);
+            });
+        }
+        static ArenaDocument ParseFile(const char *path,int opt = DefaultOptions) {
+            return Create([&](){
+                return T::ParseFile(path,opt);
+            });
+        }
+        /**
+         * @brief Create an empty document in a new arena,same arguments as T::New()
+         * 
+         */
+        template<class ...Args>
+        static ArenaDocument New(Args &&...args) {
+            return Create([&](){
+                return T::New(std::forward<Args>(args)...);
+            });
+        }
+    private:
+        /**
+         * @brief Copy the last error to the heap,it may be allocated in the arena
+         * 
+         */
+        struct ErrorGuard {
+            ~ErrorGuard() {
+                if(xmlErrorPtr err = xmlGetLastError()){
+                    xmlError copy;
+                    std::memset(&copy,0,sizeof(copy));
+                    xmlCopyError(err,&copy);
+                    xmlCopyError(&copy,err);
+                    xmlResetError(&copy);
+                }
+            }
+        };
+        template<class Fn>
+        static ArenaDocument Create(Fn &&fn) {
+            //Make sure the globals are not allocated in the arena
+            xmlInitParser();
+
+            ArenaDocument doc;
+            doc.arena.reset(new Arena());
+            ErrorGuard  guard;
+            ArenaScope  scope(*doc.arena);
+            doc.T::assign(fn());
+            return doc;
+        }
+
+        std::unique_ptr<Arena> arena;
+};
+
+using XmlArenaDocument = ArenaDocument<XmlDocument>;
+using HtmlArenaDocument = ArenaDocument<HtmlDocument>;
+
+LXML_NS_END
+
+//--DocumentBuilder
+LXML_NS_BEGIN
+/**
+ * @brief Fast DOM construction,names are interned in the document dict and nodes are linked directly
+ * 
+ * It works like XmlWriter: start_element() appends to the current element and makes the new one current.
+ * Text and attribute values are copied from the views,no temporary zero terminated strings.
+ * Bound to an ArenaDocument,the nodes,names and text come from its arena,
+ * it is made current only around these allocations (not while the builder lives).
+ * 
+ * @note The node register callbacks of libxml2 (xmlRegisterNodeDefault) are not called
+ */
+class DocumentBuilder {
+    public:
+        explicit DocumentBuilder(DocumentRef doc) : doc(doc.get()) {
+            init();
+        }
+        /**
+         * @brief Build in the arena of the document,Arena::Install() must have been called
+         * 
+         */
+        template<class T>
+        explicit DocumentBuilder(ArenaDocument<T> &doc) : doc(doc.get()) {
+            LXML_CHECK(doc.get_arena() != nullptr);
+            arena = doc.get_arena();
+            init();
+        }
+        DocumentBuilder(const DocumentBuilder &) = delete;
+        ~DocumentBuilder() = default;
+    public:
+        /**
+         * @brief Append an element to the current one (or set it as root) and make it current
+         * 
+         * @note Without a current element the document must have no root yet,a second root is an error
+         */
+        NodeRef start_element(u8string_view name) {
+            if(cur == nullptr && xmlDocGetRootElement(doc) != nullptr){
+                LXML_THROW(std::runtime_error("The document already has a root element"));
+                return NodeRef();
+            }
+            xmlNodePtr node = new_node(XML_ELEMENT_NODE,intern(name));
+            if(cur != nullptr){
+                link(cur,node);
+            }
+            else{
+                set_root(node);
+            }
+            cur = node;
+            return NodeRef(node);
+        }
+        /**
+         * @brief Make the parent of the current element current
+         * 
+         */
+        void end_element() {
+            if(cur != nullptr){
+                cur = cur->parent != nullptr && cur->parent->type == XML_ELEMENT_NODE ? cur->parent : nullptr;
+            }
+        }
+        /**
+         * @brief Add an attribute to the current element,no check of duplicates
+         * 
+         */
+        void attribute(u8string_view name,u8string_view value) {
+            if(cur == nullptr){
+                return;
+            }
+            Slab       slab(arena);
+            xmlAttrPtr attr = static_cast<xmlAttrPtr>(xmlMalloc(sizeof(xmlAttr)));
+            LXML_CHECK(attr != nullptr);
+            std::memset(attr,0,sizeof(xmlAttr));
+            attr->type = XML_ATTRIBUTE_NODE;
+            attr->name = intern(name);
+            attr->parent = cur;
+            attr->doc = doc;
+            if(!value.empty()){
+                xmlNodePtr text = new_text(value);
+                text->parent = reinterpret_cast<xmlNodePtr>(attr);
+                attr->children = text;
+                attr->last = text;
+            }
+            if(last_attr != nullptr && last_attr->parent == cur && last_attr->next == nullptr){
+                last_attr->next = attr;
+                attr->prev = last_attr;
+            }
+            else if(cur->properties != nullptr){
+                xmlAttrPtr tail = cur->properties;
+                while(tail->next != nullptr){
+                    tail = tail->next;
+                }
+                tail->next = attr;
+                attr->prev = tail;
+            }
+            else{
+                cur->properties = attr;
+            }
+            last_attr = attr;
+        }
+        /**
+         * @brief Append a text node to the current element
+         * 
+         */
+        NodeRef text(u8string_view s) {
+            if(cur == nullptr){
+                return NodeRef();
+            }
+            xmlNodePtr node = new_text(s);
+            link(cur,node);
+            return NodeRef(node);
+        }
+        template<class V,class = std::enable_if_t<std::is_arithmetic<V>::value>>
+        void attribute(u8string_view name,V value) {
+            char buf[64];
+            attribute(name,Format(buf,value));
+        }
+        template<class V,class = std::enable_if_t<std::is_arithmetic<V>::value>>
+        NodeRef text(V value) {
+            char buf[64];
+            return text(Format(buf,value));
+        }
+        /**
+         * @brief Append <name>text</name> to the current element
+         * 
+         */
+        NodeRef element(u8string_view name,u8string_view s) {
+            NodeRef node = start_element(name);
+            if(!s.empty()){
+                text(s);
+            }
+            end_element();
+            return node;
+        }
+        /**
+         * @brief Append n empty elements with the same name to the current element,the name is interned once
+         * 
+         * @return The first one (null if n is 0),walk the others by next_sibling()
+         */
+        NodeRef append_elements(u8string_view name,size_t n) {
+            if(cur == nullptr || n == 0){
+                return NodeRef();
+            }
+            const xmlChar *interned = intern(name);
+            xmlNodePtr     first = nullptr;
+            xmlNodePtr     prev = cur->last;
+            for(size_t i = 0;i < n;i++){
+                xmlNodePtr node = new_node(XML_ELEMENT_NODE,interned);
+                node->parent = cur;
+                node->prev = prev;
+                if(prev != nullptr){
+                    prev->next = node;
+                }
+                else{
+                    cur->children = node;
+                }
+                prev = node;
+                first = first == nullptr ? node : first;
+            }
+            cur->last = prev;
+            return NodeRef(first);
+        }
+        /**
+         * @brief Get the current element
+         * 
+         */
+        NodeRef current() const noexcept {
+            return NodeRef(cur);
+        }
+        /**
+         * @brief Continue building in the element,it must belong to the document
+         * 
+         */
+        void set_current(NodeRef node) noexcept {
+            cur = node.get();
+        }
+        /**
+         * @brief Intern the string in the document dict
+         * 
+         */
+        const xmlChar *intern(u8string_view s) {
+            Slab           slab(arena);
+            const xmlChar *ret = xmlDictLookup(doc->dict,BAD_CAST s.data(),int(s.size()));
+            LXML_CHECK(ret != nullptr);
+            return ret;
+        }
+        DocumentRef document() const noexcept {
+            return DocumentRef(doc);
+        }
+    private:
+        template<class V>
+        static u8string_view Format(char (&buf)[64],V value) {
+            if constexpr(std::is_same<V,bool>::value){
+                return value ? "true" : "false";
+            }
+            else{
+                auto ret = std::to_chars(buf,buf + sizeof(buf),value);
+                return u8string_view(buf,ret.ptr - buf);
+            }
+        }
+        //Make the arena current during an allocation,nothing for a plain document
+        class Slab {
+            public:
+                Slab(Arena *arena) : prev(Arena::Current()) {
+                    if(arena != nullptr){
+                        Arena::Current() = arena;
+                    }
+                }
+                Slab(const Slab &) = delete;
+                ~Slab() {
+                    Arena::Current() = prev;
+                }
+            private:
+                Arena *prev;
+        };
+
+        void init() {
+            LXML_CHECK(doc != nullptr);
+            Slab slab(arena);
+            if(doc->dict == nullptr){
+                //Freed by xmlFreeDoc,the names not owned by it are still freed one by one
+                doc->dict = xmlDictCreate();
+                LXML_CHECK(doc->dict != nullptr);
+            }
+            cur = xmlDocGetRootElement(doc);
+        }
+        xmlNodePtr new_node(xmlElementType type,const xmlChar *name) {
+            Slab       slab(arena);
+            xmlNodePtr node = static_cast<xmlNodePtr>(xmlMalloc(sizeof(xmlNode)));
+            LXML_CHECK(node != nullptr);
+            std::memset(node,0,sizeof(xmlNode));
+            node->type = type;
+            node->name = name;
+            node->doc = doc;
+            return node;
+        }
+        xmlNodePtr new_text(u8string_view s) {
+            xmlNodePtr node = new_node(XML_TEXT_NODE,xmlStringText);
+            Slab       slab(arena);
+            node->content = xmlStrndup(BAD_CAST s.data(),int(s.size()));
+            LXML_CHECK(node->content != nullptr || s.empty());
+            return node;
+        }
+        static void link(xmlNodePtr parent,xmlNodePtr node) noexcept {
+            node->parent = parent;
+            if(parent->last != nullptr){
+                parent->last->next = node;
+                node->prev = parent->last;
+            }
+            else{
+                parent->children = node;
+            }
+            parent->last = node;
+        }
+        //The document has no root,checked by start_element()
+        void set_root(xmlNodePtr node) {
+            xmlDocSetRootElement(doc,node);
+        }
+
+        xmlDocPtr  doc;
+        xmlNodePtr cur = nullptr;
+        xmlAttrPtr last_attr = nullptr;
+        Arena     *arena = nullptr;//< Arena of an ArenaDocument
+};
+
+LXML_NS_END
+
+
+//--Batch
+LXML_NS_BEGIN
+/**
+ * @brief Result of a document in ParseBatch
+ * 
+ */
+template<class T>
+struct ParseResult {
+    T        document;
+    u8string error;//< Empty on success
+    u8string warning;//< Last error the parser recovered from (see Recover),the document is still usable
+
+    bool ok() const noexcept {
+        return document.get() != nullptr && error.empty();
+    }
+};
+
+namespace Detail {
+    /**
+     * @brief Range of the inputs owned by a worker,others steal from it when they are idle
+     * 
+     */
+    struct alignas(64) BatchRange {
+        std::atomic<size_t> next{0};
+        size_t              end = 0;
+    };
+    template<class T>
+    void ParseOne(u8string_view str,int opt,ParseResult<T> &result) {
+        xmlResetLastError();
+#ifndef LXML_NO_EXCEPTIONS
+        try{
+            result.document = T::Parse(str,opt);
+        }
+        catch(std::exception &err){
+            result.error = GetError();
+            if(result.error.empty()){
+                result.error = err.what();
+            }
+            return;
+        }
+#else
+        result.document = T::Parse(str,opt);
+#endif
+        if(result.document.get() == nullptr){
+            result.error = GetError();
+            if(result.error.empty()){
+                result.error = "Failed to parse document";
+            }
+        }
+        else{
+            result.warning = GetError();
+        }
+    }
+    /**
+     * @brief Run worker(i) for i in [0,threads),worker(0) on the calling thread
+     * 
+     * The exceptions are caught per worker,on the first one stop() is called and it is rethrown
+     * after all the threads joined. If a thread can't be started,the running workers must take over its part.
+     */
+    template<class Fn,class Stop>
+    void RunWorkers(size_t threads,Fn &&worker,Stop &&stop) {
+        std::vector<std::thread> pool;
+#ifndef LXML_NO_EXCEPTIONS
+        std::exception_ptr first;
+        std::mutex         mutex;
+        auto guarded = [&](size_t i){
+            try{
+                worker(i);
+            }
+            catch(...){
+                std::lock_guard<std::mutex> locker(mutex);
+                if(!first){
+                    first = std::current_exception();
+                    stop();
+                }
+            }
+        };
+        try{
+            pool.reserve(threads - 1);
+            for(size_t i = 1;i < threads;i++){
+                pool.emplace_back(guarded,i);
+            }
+        }
+        catch(...){
+            //Out of threads or memory,go on with the started ones
+        }
+        guarded(0);
+        for(auto &thread : pool){
+            thread.join();
+        }
+        if(first){
+            std::rethrow_exception(first);
+        }
+#else
+        (void)stop;
+        pool.reserve(threads - 1);
+        for(size_t i = 1;i < threads;i++){
+            pool.emplace_back(worker,i);
+        }
+        worker(0);
+        for(auto &thread : pool){
+            thread.join();
+        }
+#endif
+    }
+}
+
+/**
+ * @brief Parse many documents in parallel
+ * 
+ * @tparam T XmlDocument or HtmlDocument
+ * @param inputs Pointer to the inputs
+ * @param n Number of the inputs
+ * @param threads Number of threads,0 on std::thread::hardware_concurrency()
+ * @param opt Parse options
+ * @return std::vector<ParseResult<T>> in the same order of inputs
+ * @note A Library should be alive. With Recover (the default) a broken document is usually kept,
+ *       error stays empty and the recovered error is in warning
+ */
+template<class T = XmlDocument>
+std::vector<ParseResult<T>> ParseBatch(const u8string_view *inputs,size_t n,size_t threads = 0,int opt = DefaultOptions) {
+    std::vector<ParseResult<T>> results(n);
+    if(threads == 0){
+        threads = std::thread::hardware_concurrency();
+    }
+    if(threads == 0){
+        threads = 1;
+    }
+    if(threads > n){
+        threads = n;
+    }
+    if(threads <= 1){
+        for(size_t i = 0;i < n;i++){
+            Detail::ParseOne(inputs[i],opt,results[i]);
+        }
+        return results;
+    }
+    //Split the inputs into ranges,one per worker
+    std::unique_ptr<Detail::BatchRange[]> ranges(new Detail::BatchRange[threads]);
+    for(size_t i = 0;i < threads;i++){
+        ranges[i].next = n * i / threads;
+        ranges[i].end = n * (i + 1) / threads;
+    }
+    auto worker = [&](size_t self){
+        //Drain own range first,then steal from the others
+        for(size_t k = 0;k < threads;k++){
+            auto &range = ranges[(self + k) % threads];
+            size_t i;
+            while((i = range.next.fetch_add(1,std::memory_order_relaxed)) < range.end){
+                Detail::ParseOne(inputs[i],opt,results[i]);
+            }
+        }
+    };
+    auto stop = [&](){
+        for(size_t i = 0;i < threads;i++){
+            ranges[i].next.store(ranges[i].end,std::memory_order_relaxed);
+        }
+    };
+    Detail::RunWorkers(threads,worker,stop);
+    return results;
+}
+/**
+ * @brief Parse many documents in parallel
+ * 
+ * @param inputs Any contiguous container of u8string_view (std::vector,std::array,std::span...)
+ */
+template<class T = XmlDocument,class Container>
+std::vector<ParseResult<T>> ParseBatch(const Container &inputs,size_t threads = 0,int opt = DefaultOptions) {
+    return ParseBatch<T>(std::data(inputs),std::size(inputs),threads,opt);
+}
+
+//--Records
+/**
+ * @brief Records ParseRecords could not parse
+ * 
+ */
+struct RecordError {
+    size_t   first = 0;//< Index of the first record
+    size_t   last = 0;//< Index past the last record,equal to first if the whole document failed
+    u8string error;
+};
+/**
+ * @brief Result of the structural prescan of a record oriented document
+ * 
+ */
+struct RecordScan {
+    size_t        prolog_end = 0;//< Offset past the start tag of the root
+    u8string_view root;//< Qualified name of the root
+    std::vector<std::pair<size_t,size_t>> records;//< [begin,end) of the records,children of the root
+    bool          ok = false;//< The structure was understood
+};
+namespace Detail {
+    inline size_t FindText(u8string_view s,size_t from,u8string_view what) noexcept {
+        size_t pos = s.find(what,from);
+        return pos == u8string_view::npos ? s.size() : pos + what.size();
+    }
+    /**
+     * @brief Find the '>' closing a tag,skipping quoted attribute values
+     * 
+     * @return Offset past the '>',npos on end of input
+     */
+    inline size_t FindTagEnd(u8string_view s,size_t pos) noexcept {
+        const char *p = s.data();
+        size_t      n = s.size();
+        while(pos < n){
+            char c = p[pos];
+            if(c == '>'){
+                return pos + 1;
+            }
+            if(c == '"' || c == '\''){
+                const void *q = std::memchr(p + pos + 1,c,n - pos - 1);
+                if(q == nullptr){
+                    return u8string_view::npos;
+                }
+                pos = static_cast<const char *>(q) - p;
+            }
+            pos++;
+        }
+        return u8string_view::npos;
+    }
+    //<!DOCTYPE ...> with the internal subset
+    inline size_t FindDoctypeEnd(u8string_view s,size_t pos) noexcept {
+        int  brackets = 0;
+        char quote = 0;
+        for(;pos < s.size();pos++){
+            char c = s[pos];
+            if(quote != 0){
+                quote = c == quote ? 0 : quote;
+            }
+            else if(c == '"' || c == '\''){
+                quote = c;
+            }
+            else if(c == '['){
+                brackets++;
+            }
+            else if(c == ']'){
+                brackets--;
+            }
+            else if(c == '>' && brackets <= 0){
+                return pos + 1;
+            }
+        }
+        return u8string_view::npos;
+    }
+    inline bool IsNameEnd(char c) noexcept {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>';
+    }
+    //Compare the qualified name (prefix:name) of a element
+    inline bool QNameEquals(const xmlNode *node,u8string_view qname) noexcept {
+        if(node->ns != nullptr && node->ns->prefix != nullptr){
+            size_t len = xmlStrlen(node->ns->prefix);
+            return qname.size() > len && qname[len] == ':' &&
+                   NameEquals(node->ns->prefix,qname.substr(0,len)) &&
+                   NameEquals(node->name,qname.substr(len + 1));
+        }
+        return NameEquals(node->name,qname);
+    }
+}
+/**
+ * @brief Find the records (children of the root named name) by a structural prescan,without building any tree
+ * 
+ * It understands comments,CDATA,processing instructions,the doctype and quoted attribute values,
+ * the content is not validated (the parser does it later).
+ */
+inline RecordScan ScanRecords(u8string_view s,u8string_view name) {
+    RecordScan scan;
+    const char *p = s.data();
+    size_t      n = s.size();
+    size_t      pos = 0;
+    size_t      depth = 0;
+    size_t      begin = 0;
+    bool        in_record = false;
+    while(true){
+        const void *lt = pos < n ? std::memchr(p + pos,'<',n - pos) : nullptr;
+        if(lt == nullptr){
+            //Root not closed
+            return scan;
+        }
+        size_t tag = static_cast<const char *>(lt) - p;
+        if(tag + 1 >= n){
+            return scan;
+        }
+        char c = p[tag + 1];
+        if(c == '?'){
+            pos = Detail::FindText(s,tag + 2,"?>");
+        }
+        else if(c == '!'){
+            u8string_view rest = s.substr(tag);
+            if(rest.compare(0,4,"<!--") == 0){
+                pos = Detail::FindText(s,tag + 4,"-->");
+            }
+            else if(rest.compare(0,9,"<![CDATA[") == 0){
+                pos = Detail::FindText(s,tag + 9,"]]>");
+            }
+            else{
+                pos = Detail::FindDoctypeEnd(s,tag + 2);
+            }
+        }
+        else if(c == '/'){
+            pos = Detail::FindTagEnd(s,tag + 2);
+            if(pos == u8string_view::npos || depth == 0){
+                return scan;
+            }
+            depth--;
+            if(depth == 1 && in_record){
+                scan.records.emplace_back(begin,pos);
+                in_record = false;
+            }
+            else if(depth == 0){
+                scan.ok = true;
+                return scan;
+            }
+        }
+        else{
+            size_t end = Detail::FindTagEnd(s,tag + 1);
+            if(end == u8string_view::npos){
+                return scan;
+            }
+            bool   empty = p[end - 2] == '/';
+            size_t name_end = tag + 1;
+            while(name_end < end && !Detail::IsNameEnd(p[name_end])){
+                name_end++;
+            }
+            u8string_view qname = s.substr(tag + 1,name_end - tag - 1);
+            if(depth == 0){
+                scan.root = qname;
+                scan.prolog_end = end;
+                if(empty){
+                    scan.ok = true;
+                    return scan;
+                }
+            }
+            else if(depth == 1 && qname == name){
+                begin = tag;
+                in_record = !empty;
+                if(empty){
+                    scan.records.emplace_back(tag,end);
+                }
+            }
+            if(!empty){
+                depth++;
+            }
+            pos = end;
+        }
+        if(pos == u8string_view::npos || pos > n){
+            return scan;
+        }
+    }
+}
+
+namespace Detail {
+    /**
+     * @brief Parse the pieces as one xml document by a push parser
+     * 
+     * @param error Set on failure
+     * @return xmlDocPtr (nullptr on failure,or not well formed without Recover)
+     */
+    inline xmlDocPtr ParsePieces(std::initializer_list<u8string_view> pieces,int opt,u8string &error) {
+        xmlParserCtxtPtr ctxt = xmlCreatePushParserCtxt(nullptr,nullptr,nullptr,0,nullptr);
+        if(ctxt == nullptr){
+            error = "Failed to create xml parser";
+            return nullptr;
+        }
+        xmlCtxtUseOptions(ctxt,opt);
+        for(u8string_view piece : pieces){
+            FeedPieces(piece.data(),piece.size(),[ctxt](const char *data,int n){
+                //The errors are collected by the context,go on like a single xmlParseChunk
+                xmlParseChunk(ctxt,data,n,0);
+                return 0;
+            });
+        }
+        xmlParseChunk(ctxt,nullptr,0,1);
+
+        xmlDocPtr doc = ctxt->myDoc;
+        ctxt->myDoc = nullptr;
+        if(doc != nullptr && !ctxt->wellFormed && !(opt & Recover)){
+            xmlFreeDoc(doc);
+            doc = nullptr;
+        }
+        if(doc == nullptr){
+            error = ctxt->lastError.message != nullptr ? ctxt->lastError.message : "Failed to parse xml document";
+        }
+        xmlFreeParserCtxt(ctxt);
+        return doc;
+    }
+    /**
+     * @brief Parse the records [first,last) as the children of a copy of the root,and hand them to fn
+     * 
+     * @param error Set if the chunk failed to parse
+     * @return Number of the records handed to fn
+     */
+    template<class Fn>
+    size_t ParseRecordChunk(u8string_view s,const RecordScan &scan,size_t first,size_t last,u8string_view name,int opt,Fn &fn,
+                            u8string &error) {
+        size_t begin = scan.records[first].first;
+        size_t end = scan.records[last - 1].second;
+        u8string close = "</";
+        close.append(scan.root.data(),scan.root.size());
+        close += '>';
+
+        //Prolog (xml declaration,doctype with entities) and the root start tag keep the namespaces in scope
+        XmlDocument owner(ParsePieces({s.substr(0,scan.prolog_end),s.substr(begin,end - begin),close},opt,error));
+        if(owner.get() == nullptr){
+            return 0;
+        }
+        size_t index = first;
+        size_t count = 0;
+        for(auto record : owner.root_node().elements()){
+            if(index < last && QNameEquals(record.get(),name)){
+                fn(record,index++);
+                count++;
+            }
+        }
+        return count;
+    }
+}
+/**
+ * @brief Parse a document made of many records (children of the root) on many threads
+ * 
+ * The records are found by ScanRecords,grouped into chunks and every chunk is parsed
+ * as a small document made of the prolog,the root start tag and the records.
+ * 
+ * @param input The whole document
+ * @param name Qualified name of the records,other children of the root are skipped
+ * @param fn Callback void(NodeRef record,size_t index),called concurrently from the workers;
+ *           the record is valid during the call only (clone it to keep it)
+ * @param threads Number of threads,0 on std::thread::hardware_concurrency()
+ * @param errors Filled with the chunks that failed to parse (their records are skipped),sorted by the index;
+ *               if nullptr,the first failure is thrown as std::runtime_error
+ * @return Number of the records handed to fn
+ * @note A Library should be alive. If the structure is not understood,the whole document is parsed on the calling thread.
+ *       If fn throws,the other workers stop after their current chunk and the first exception is rethrown here
+ */
+template<class Fn>
+size_t ParseRecords(u8string_view input,u8string_view name,Fn &&fn,size_t threads = 0,int opt = DefaultOptions,
+                    std::vector<RecordError> *errors = nullptr) {
+    RecordScan scan = ScanRecords(input,name);
+    if(!scan.ok){
+        u8string    error;
+        XmlDocument doc(Detail::ParsePieces({input},opt,error));
+        if(doc.get() == nullptr){
+            if(errors != nullptr){
+                errors->push_back({0,0,std::move(error)});
+                return 0;
+            }
+            LXML_THROW(std::runtime_error(error));
+            return 0;
+        }
+        if(doc.root_node().is_null()){
+            return 0;
+        }
+        size_t index = 0;
+        for(auto record : doc.root_node().elements()){
+            if(Detail::QNameEquals(record.get(),name)){
+                fn(record,index++);
+            }
+        }
+        return index;
+    }
+    size_t n = scan.records.size();
+    if(n == 0){
+        return 0;
+    }
+    if(threads == 0){
+        threads = std::thread::hardware_concurrency();
+    }
+    if(threads == 0){
+        threads = 1;
+    }
+    //Chunks of about LXML_FILE_CHUNK_SIZE bytes,several per thread for the balance
+    size_t bytes = scan.records.back().second - scan.records.front().first;
+    size_t target = bytes / (threads * 8) + 1;
+    if(target > LXML_FILE_CHUNK_SIZE){
+        target = LXML_FILE_CHUNK_SIZE;
+    }
+    std::vector<size_t> chunks {0};
+    for(size_t i = 0;i < n;i++){
+        if(scan.records[i].second - scan.records[chunks.back()].first >= target){
+            chunks.push_back(i + 1);
+        }
+    }
+    if(chunks.back() != n){
+        chunks.push_back(n);
+    }
+    size_t nchunks = chunks.size() - 1;
+    if(threads > nchunks){
+        threads = nchunks;
+    }
+
+    std::atomic<size_t> next {0};
+    std::atomic<size_t> total {0};
+    std::mutex          mutex;
+    size_t              reported = errors != nullptr ? errors->size() : 0;
+    auto worker = [&](size_t){
+        size_t   i;
+        u8string error;
+        while((i = next.fetch_add(1,std::memory_order_relaxed)) < nchunks){
+            total.fetch_add(
+                Detail::ParseRecordChunk(input,scan,chunks[i],chunks[i + 1],name,opt,fn,error),
+                std::memory_order_relaxed
+            );
+            if(error.empty()){
+                continue;
+            }
+            if(errors == nullptr){
+                LXML_THROW(std::runtime_error(error));
+            }
+            else{
+                std::lock_guard<std::mutex> locker(mutex);
+                errors->push_back({chunks[i],chunks[i + 1],std::move(error)});
+            }
+            error.clear();
+        }
+    };
+    auto stop = [&](){
+        next.store(nchunks,std::memory_order_relaxed);
+    };
+    Detail::RunWorkers(threads,worker,stop);
+    if(errors != nullptr){
+        std::sort(errors->begin() + reported,errors->end(),[](const RecordError &a,const RecordError &b){
+            return a.first < b.first;
+        });
+    }
+    return total.load();
+}
+/**
+ * @brief ParseRecords on a file,it is mapped into memory instead of being copied
+ * 
+ * @note A file that can't be opened is reported like a document that fails to parse
+ */
+template<class Fn>
+size_t ParseRecordsFile(const char *path,u8string_view name,Fn &&fn,size_t threads = 0,int opt = DefaultOptions,
+                        std::vector<RecordError> *errors = nullptr) {
+    Detail::MappedFile file(path);
+    if(!file.is_mapped()){
+        //Not a regular file,read it into memory
+        std::FILE *fp = std::fopen(path,"rb");
+        if(fp == nullptr){
+            u8string error = "cannot open ";
+            error += path;
+            if(errors != nullptr){
+                errors->push_back({0,0,std::move(error)});
+                return 0;
+            }
+            LXML_THROW(std::runtime_error(error));
+            return 0;
+        }
+        u8string buffer;
+        char     chunk[LXML_OUTPUT_CHUNK_SIZE];
+        size_t   len;
+        while((len = std::fread(chunk,1,sizeof(chunk),fp)) > 0){
+            buffer.append(chunk,len);
+        }
+        std::fclose(fp);
+        return ParseRecords(buffer,name,std::forward<Fn>(fn),threads,opt,errors);
+    }
+    return ParseRecords(u8string_view(file.data(),file.size()),name,std::forward<Fn>(fn),threads,opt,errors);
+}
+
+LXML_NS_END
+
+//--FrozenDocument
+LXML_NS_BEGIN
+/**
+ * @brief Attribute of a FrozenNode,the views point into the string pool
+ * 
+ */
+struct FrozenAttribute {
+    u8string_view name;
+    u8string_view value;
+};
+namespace Detail {
+    struct FrozenString {
+        uint32_t offset;
+        uint32_t size;
+    };
+    /**
+     * @brief Node of the flat pre-order array,the subtree of node i is [i + 1,end)
+     * 
+     */
+    struct FrozenRecord {
+        uint32_t     parent;//< npos on the document node
+        uint32_t     end;
+        uint32_t     name;//< Name id,npos on none
+        uint32_t     type;//< xmlElementType
+        FrozenString text;//< Content of text / comment / pi nodes
+        uint32_t     attrs;//< First attribute
+        uint32_t     attr_count;
+    };
+    struct FrozenAttr {
+        uint32_t     name;
+        FrozenString value;
+    };
+    struct FrozenStep;
+}
+/**
+ * @brief Read only view of a node in a FrozenDocument,like NodeRef
+ * 
+ */
+class FrozenNode {
+    public:
+        FrozenNode() = default;
+        FrozenNode(const FrozenDocument *doc,uint32_t index) : doc(doc), idx(index) {}
+
+        bool operator ==(const FrozenNode &other) const noexcept {
+            return doc == other.doc && idx == other.idx;
+        }
+        bool operator !=(const FrozenNode &other) const noexcept {
+            return !(*this == other);
+        }
+        bool operator ==(std::nullptr_t) const noexcept {
+            return doc == nullptr;
+        }
+        bool operator !=(std::nullptr_t) const noexcept {
+            return doc != nullptr;
+        }
+        //For iterator etc...
+        const FrozenNode *operator ->() const noexcept {
+            return this;
+        }
+    public:
+        bool is_null() const noexcept {
+            return doc == nullptr;
+        }
+        uint32_t index() const noexcept {
+            return idx;
+        }
+        xmlElementType type() const noexcept;
+        bool is_element() const noexcept {
+            return type() == XML_ELEMENT_NODE;
+        }
+        bool is_text() const noexcept {
+            return type() == XML_TEXT_NODE || type() == XML_CDATA_SECTION_NODE;
+        }
+        bool is_comment() const noexcept {
+            return type() == XML_COMMENT_NODE;
+        }
+        bool is_document() const noexcept {
+            return type() == XML_DOCUMENT_NODE;
+        }
+        //--Name
+        u8string_view name_view() const noexcept;
+        uint32_t      name_id() const noexcept;
+        //--Content
+        /**
+         * @brief Get the content of text / comment / pi nodes
+         * 
+         */
+        u8string_view value_view() const noexcept;
+        /**
+         * @brief Get the text of the node and its descendants
+         * 
+         */
+        u8string      content() const;
+        //--Attributes
+        u8string_view attribute_view(u8string_view name) const noexcept;
+        bool          has_attribute(u8string_view name) const noexcept;
+        FrozenAttributes attributes() const noexcept;
+        //--Tree
+        FrozenNode parent() const noexcept;
+        FrozenNode first_child() const noexcept;
+        FrozenNode next_sibling() const noexcept;
+        FrozenChildren children() const noexcept;
+        FrozenElements elements() const noexcept;
+        /**
+         * @brief Get all the descendant elements,it is a linear scan of the subtree
+         * 
+         */
+        FrozenDescendants descendants() const noexcept;
+        FrozenDescendants descendants(u8string_view name) const noexcept;
+        //--Query
+        /**
+         * @brief Evaluate a xpath subset: / and // steps,name or *,. and ..,
+         *        [@attr],[@attr='value'] and [n] predicates
+         * 
+         * @return std::vector<FrozenNode> (in document order,empty on syntax error)
+         */
+        std::vector<FrozenNode> query(u8string_view path) const;
+        FrozenNode              query_first(u8string_view path) const;
+
+        const FrozenDocument *document() const noexcept {
+            return doc;
+        }
+    private:
+        const Detail::FrozenRecord &record() const noexcept;
+
+        const FrozenDocument *doc = nullptr;
+        uint32_t              idx = 0;
+};
+/**
+ * @brief Iterator over the siblings,it jumps over the subtrees by the end index
+ * 
+ * @tparam ElementsOnly Skip the nodes which are not element
+ */
+template<bool ElementsOnly>
+class FrozenChildIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FrozenNode;
+        using difference_type = std::ptrdiff_t;
+        using pointer = FrozenNode;
+        using reference = FrozenNode;
+
+        FrozenChildIterator() = default;
+        FrozenChildIterator(const FrozenDocument *doc,uint32_t cur,uint32_t end) : doc(doc), cur(cur), end(end) {
+            skip();
+        }
+
+        bool operator ==(const FrozenChildIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const FrozenChildIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        FrozenChildIterator &operator ++() noexcept;
+        FrozenChildIterator operator ++(int) noexcept {
+            FrozenChildIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        FrozenNode operator  *() const noexcept {
+            return FrozenNode(doc,cur);
+        }
+        FrozenNode operator ->() const noexcept {
+            return FrozenNode(doc,cur);
+        }
+    private:
+        void skip() noexcept;
+
+        const FrozenDocument *doc = nullptr;
+        uint32_t              cur = 0;
+        uint32_t              end = 0;
+};
+/**
+ * @brief Iterator over the descendant elements,it walks the array linearly
+ * 
+ */
+class FrozenDescendantIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FrozenNode;
+        using difference_type = std::ptrdiff_t;
+        using pointer = FrozenNode;
+        using reference = FrozenNode;
+
+        FrozenDescendantIterator() = default;
+        FrozenDescendantIterator(const FrozenDocument *doc,uint32_t cur,uint32_t end,uint32_t name) :
+            doc(doc), cur(cur), end(end), name(name) {
+            skip();
+        }
+
+        bool operator ==(const FrozenDescendantIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const FrozenDescendantIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        FrozenDescendantIterator &operator ++() noexcept {
+            cur++;
+            skip();
+            return *this;
+        }
+        FrozenDescendantIterator operator ++(int) noexcept {
+            FrozenDescendantIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        FrozenNode operator  *() const noexcept {
+            return FrozenNode(doc,cur);
+        }
+        FrozenNode operator ->() const noexcept {
+            return FrozenNode(doc,cur);
+        }
+    private:
+        void skip() noexcept;
+
+        const FrozenDocument *doc = nullptr;
+        uint32_t              cur = 0;
+        uint32_t              end = 0;
+        uint32_t              name = 0;//< Name id,npos on any
+};
+template<class Iterator>
+class FrozenRange {
+    public:
+        using iterator = Iterator;
+        using const_iterator = Iterator;
+        using value_type = typename Iterator::value_type;
+
+        FrozenRange(Iterator first,Iterator last) : first(first), last(last) {}
+
+        iterator begin() const noexcept {
+            return first;
+        }
+        iterator end() const noexcept {
+            return last;
+        }
+        bool empty() const noexcept {
+            return first == last;
+        }
+    private:
+        Iterator first;
+        Iterator last;
+};
+class FrozenAttributeIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FrozenAttribute;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const FrozenAttribute *;
+        using reference = FrozenAttribute;
+
+        FrozenAttributeIterator() = default;
+        FrozenAttributeIterator(const FrozenDocument *doc,uint32_t cur) : doc(doc), cur(cur) {}
+
+        bool operator ==(const FrozenAttributeIterator &iter) const noexcept {
+            return cur == iter.cur;
+        }
+        bool operator !=(const FrozenAttributeIterator &iter) const noexcept {
+            return cur != iter.cur;
+        }
+        FrozenAttributeIterator &operator ++() noexcept {
+            cur++;
+            return *this;
+        }
+        FrozenAttributeIterator operator ++(int) noexcept {
+            FrozenAttributeIterator tmp(*this);
+            cur++;
+            return tmp;
+        }
+        FrozenAttribute operator *() const noexcept;
+    private:
+        const FrozenDocument *doc = nullptr;
+        uint32_t              cur = 0;
+};
+/**
+ * @brief Flat,read only snapshot of a document
+ * 
+ * The nodes are stored in one pre-order array (parent / subtree end indices),
+ * names are interned to ids and all the strings live in one pool,
+ * so traversals touch a few contiguous arrays instead of chasing xmlNode pointers.
+ * It doesn't refer to the source document,which could be freed after the freeze.
+ * 
+ * @note Entity references which were not substituted (see NoEntities) are dropped
+ */
+class FrozenDocument {
+    public:
+        static constexpr uint32_t npos = uint32_t(-1);
+
+        FrozenDocument() = default;
+        FrozenDocument(const FrozenDocument &) = delete;
+        FrozenDocument(FrozenDocument &&) = default;
+        ~FrozenDocument() = default;
+
+        FrozenDocument &operator =(FrozenDocument &&) = default;
+    public:
+        /**
+         * @brief Get the document node,the parent of the root element
+         * 
+         */
+        FrozenNode document() const noexcept {
+            return nodes.empty() ? FrozenNode() : FrozenNode(this,0);
+        }
+        /**
+         * @brief Get the root element
+         * 
+         * @return FrozenNode (null on none)
+         */
+        FrozenNode root_node() const noexcept {
+            if(nodes.empty()){
+                return FrozenNode();
+            }
+            auto elements = document().elements();
+            return elements.empty() ? FrozenNode() : *elements.begin();
+        }
+        FrozenNode node(uint32_t index) const noexcept {
+            return FrozenNode(this,index);
+        }
+        size_t size() const noexcept {
+            return nodes.size();
+        }
+        bool empty() const noexcept {
+            return nodes.empty();
+        }
+        /**
+         * @brief Get the id of the name
+         * 
+         * @return uint32_t (npos if no node has the name)
+         */
+        uint32_t name_id(u8string_view name) const noexcept {
+            auto iter = ids.find(name);
+            return iter == ids.end() ? npos : iter->second;
+        }
+        u8string_view name(uint32_t id) const noexcept {
+            return id == npos ? u8string_view() : view(names[id]);
+        }
+        std::vector<FrozenNode> query(u8string_view path) const {
+            return document().query(path);
+        }
+        FrozenNode query_first(u8string_view path) const {
+            return document().query_first(path);
+        }
+        /**
+         * @brief Get the bytes used by the arrays and the pool
+         * 
+         */
+        size_t memory_usage() const noexcept {
+            return nodes.capacity() * sizeof(Detail::FrozenRecord) +
+                   attrs.capacity() * sizeof(Detail::FrozenAttr) +
+                   names.capacity() * sizeof(Detail::FrozenString) +
+                   pool.capacity();
+        }
+        /**
+         * @brief Build the snapshot of a document
+         * 
+         */
+        static FrozenDocument Freeze(DocumentRef doc);
+    private:
+        u8string_view view(Detail::FrozenString s) const noexcept {
+            return u8string_view(pool.data() + s.offset,s.size);
+        }
+        Detail::FrozenString add_string(u8string_view s) {
+            LXML_CHECK(pool.size() + s.size() <= npos);
+            Detail::FrozenString ret {uint32_t(pool.size()),uint32_t(s.size())};
+            pool.insert(pool.end(),s.begin(),s.end());
+            return ret;
+        }
+        using Names = std::unordered_map<u8string_view,uint32_t>;
+
+        uint32_t intern(const xmlChar *name,Names &building);
+        bool     add_node(xmlNode *node,uint32_t parent,Names &building);
+
+        std::vector<Detail::FrozenRecord> nodes;
+        std::vector<Detail::FrozenAttr>   attrs;
+        std::vector<Detail::FrozenString> names;
+        Names                             ids;//< Keys point into the pool,the buffer of vector is kept on move
+        std::vector<char>                 pool;
+    friend class FrozenNode;
+    friend class FrozenDescendantIterator;
+    friend class FrozenAttributeIterator;
+    template<bool>
+    friend class FrozenChildIterator;
+};
+
+//--Impl FrozenDocument
+inline uint32_t FrozenDocument::intern(const xmlChar *name,Names &building) {
+    //The keys point into the source document while building,the pool still grows
+    auto key = ToView(name);
+    auto iter = building.find(key);
+    if(iter != building.end()){
+        return iter->second;
+    }
+    uint32_t id = uint32_t(names.size());
+    names.push_back(add_string(key));
+    building.emplace(key,id);
+    return id;
+}
+inline bool FrozenDocument::add_node(xmlNode *node,uint32_t parent,Names &building) {
+    Detail::FrozenRecord rec {parent,0,npos,uint32_t(node->type),{0,0},0,0};
+    switch(node->type){
+        case XML_ELEMENT_NODE : {
+            rec.name = intern(node->name,building);
+            rec.attrs = uint32_t(attrs.size());
+            for(xmlAttr *attr = node->properties;attr != nullptr;attr = attr->next){
+                u8string_view value;
+                lstring       scratch;
+                if(!AttributeView(attr,value)){
+                    scratch.reset(xmlNodeListGetString(node->doc,attr->children,1));
+                    value = scratch.view();
+                }
+                attrs.push_back({intern(attr->name,building),add_string(value)});
+            }
+            rec.attr_count = uint32_t(attrs.size()) - rec.attrs;
+            break;
+        }
+        case XML_PI_NODE :
+            rec.name = intern(node->name,building);
+            rec.text = add_string(ToView(node->content));
+            break;
+        case XML_TEXT_NODE :
+        case XML_CDATA_SECTION_NODE :
+        case XML_COMMENT_NODE :
+            rec.text = add_string(ToView(node->content));
+            break;
+        default :
+            return false;
+    }
+    LXML_CHECK(nodes.size() < npos);
+    nodes.push_back(rec);
+    return true;
+}
+inline FrozenDocument FrozenDocument::Freeze(DocumentRef doc) {
+    FrozenDocument frozen;
+    xmlDocPtr d = doc.get();
+    if(d == nullptr){
+        return frozen;
+    }
+    Names building;
+    frozen.nodes.push_back({npos,0,npos,uint32_t(XML_DOCUMENT_NODE),{0,0},0,0});
+
+    //Pre-order walk without stack,the end index is set when leaving the subtree
+    auto    &nodes = frozen.nodes;
+    uint32_t parent = 0;
+    xmlNode *cur = d->children;
+    while(cur != nullptr){
+        bool added = frozen.add_node(cur,parent,building);
+        uint32_t index = uint32_t(nodes.size() - 1);
+        if(added && cur->type == XML_ELEMENT_NODE && cur->children != nullptr){
+            parent = index;
+            cur = cur->children;
+            continue;
+        }
+        if(added){
+            nodes[index].end = index + 1;
+        }
+        while(cur != nullptr && cur->next == nullptr){
+            cur = cur->parent;
+            if(cur == nullptr || cur == reinterpret_cast<xmlNode*>(d)){
+                cur = nullptr;
+                break;
+            }
+            nodes[parent].end = uint32_t(nodes.size());
+            parent = nodes[parent].parent;
+        }
+        if(cur != nullptr){
+            cur = cur->next;
+        }
+    }
+    nodes[0].end = uint32_t(nodes.size());
+    nodes.shrink_to_fit();
+    frozen.attrs.shrink_to_fit();
+    frozen.pool.shrink_to_fit();
+    //The pool is final now
+    frozen.ids.reserve(frozen.names.size());
+    for(uint32_t id = 0;id < frozen.names.size();id++){
+        frozen.ids.emplace(frozen.view(frozen.names[id]),id);
+    }
+    return frozen;
+}
+inline FrozenDocument DocumentRef::freeze() const {
+    return FrozenDocument::Freeze(*this);
+}
+
+inline const Detail::FrozenRecord &FrozenNode::record() const noexcept {
+    return doc->nodes[idx];
+}
+inline xmlElementType FrozenNode::type() const noexcept {
+    return xmlElementType(record().type);
+}
+inline u8string_view FrozenNode::name_view() const noexcept {
+    return doc->name(record().name);
+}
+inline uint32_t FrozenNode::name_id() const noexcept {
+    return record().name;
+}
+inline u8string_view FrozenNode::value_view() const noexcept {
+    return doc->view(record().text);
+}
+inline u8string FrozenNode::content() const {
+    auto &rec = record();
+    if(rec.type != XML_ELEMENT_NODE && rec.type != XML_DOCUMENT_NODE){
+        return u8string(value_view());
+    }
+    u8string ret;
+    for(uint32_t i = idx + 1;i < rec.end;i++){
+        auto &node = doc->nodes[i];
+        if(node.type == XML_TEXT_NODE || node.type == XML_CDATA_SECTION_NODE){
+            auto text = doc->view(node.text);
+            ret.append(text.data(),text.size());
+        }
+    }
+    return ret;
+}
+inline u8string_view FrozenNode::attribute_view(u8string_view name) const noexcept {
+    auto &rec = record();
+    for(uint32_t i = rec.attrs;i < rec.attrs + rec.attr_count;i++){
+        auto &attr = doc->attrs[i];
+        if(doc->name(attr.name) == name){
+            return doc->view(attr.value);
+        }
+    }
+    return u8string_view();
+}
+inline bool FrozenNode::has_attribute(u8string_view name) const noexcept {
+    auto &rec = record();
+    for(uint32_t i = rec.attrs;i < rec.attrs + rec.attr_count;i++){
+        if(doc->name(doc->attrs[i].name) == name){
+            return true;
+        }
+    }
+    return false;
+}
+inline FrozenAttributes FrozenNode::attributes() const noexcept {
+    auto &rec = record();
+    return FrozenAttributes(
+        FrozenAttributeIterator(doc,rec.attrs),
+        FrozenAttributeIterator(doc,rec.attrs + rec.attr_count)
+    );
+}
+inline FrozenAttribute FrozenAttributeIterator::operator *() const noexcept {
+    auto &attr = doc->attrs[cur];
+    return FrozenAttribute {doc->name(attr.name),doc->view(attr.value)};
+}
+inline FrozenNode FrozenNode::parent() const noexcept {
+    uint32_t p = record().parent;
+    return p == FrozenDocument::npos ? FrozenNode() : FrozenNode(doc,p);
+}
+inline FrozenNode FrozenNode::first_child() const noexcept {
+    return idx + 1 < record().end ? FrozenNode(doc,idx + 1) : FrozenNode();
+}
+inline FrozenNode FrozenNode::next_sibling() const noexcept {
+    auto &rec = record();
+    if(rec.parent == FrozenDocument::npos || rec.end >= doc->nodes[rec.parent].end){
+        return FrozenNode();
+    }
+    return FrozenNode(doc,rec.end);
+}
+inline FrozenChildren FrozenNode::children() const noexcept {
+    uint32_t end = record().end;
+    return FrozenChildren(
+        FrozenChildIterator<false>(doc,idx + 1,end),
+        FrozenChildIterator<false>(doc,end,end)
+    );
+}
+inline FrozenElements FrozenNode::elements() const noexcept {
+    uint32_t end = record().end;
+    return FrozenElements(
+        FrozenChildIterator<true>(doc,idx + 1,end),
+        FrozenChildIterator<true>(doc,end,end)
+    );
+}
+inline FrozenDescendants FrozenNode::descendants() const noexcept {
+    uint32_t end = record().end;
+    return FrozenDescendants(
+        FrozenDescendantIterator(doc,idx + 1,end,FrozenDocument::npos),
+        FrozenDescendantIterator(doc,end,end,FrozenDocument::npos)
+    );
+}
+inline FrozenDescendants FrozenNode::descendants(u8string_view name) const noexcept {
+    uint32_t end = record().end;
+    uint32_t id = doc->name_id(name);
+    if(id == FrozenDocument::npos){
+        return FrozenDescendants(FrozenDescendantIterator(doc,end,end,id),FrozenDescendantIterator(doc,end,end,id));
+    }
+    return FrozenDescendants(
+        FrozenDescendantIterator(doc,idx + 1,end,id),
+        FrozenDescendantIterator(doc,end,end,id)
+    );
+}
+template<bool ElementsOnly>
+inline FrozenChildIterator<ElementsOnly> &FrozenChildIterator<ElementsOnly>::operator ++() noexcept {
+    cur = doc->nodes[cur].end;
+    skip();
+    return *this;
+}
+template<bool ElementsOnly>
+inline void FrozenChildIterator<ElementsOnly>::skip() noexcept {
+    if constexpr(ElementsOnly){
+        while(cur < end && doc->nodes[cur].type != XML_ELEMENT_NODE){
+            cur = doc->nodes[cur].end;
+        }
+    }
+}
+inline void FrozenDescendantIterator::skip() noexcept {
+    auto &nodes = doc->nodes;
+    while(cur < end && !(nodes[cur].type == XML_ELEMENT_NODE && (name == FrozenDocument::npos || nodes[cur].name == name))){
+        cur++;
+    }
+}
+
+//--Impl FrozenDocument query
+namespace Detail {
+    struct FrozenPredicate {
+        u8string attr;//< Empty on position
+        u8string value;
+        bool     has_value;
+        size_t   position;
+    };
+    struct FrozenStep {
+        bool     descendant;//< Step after //
+        u8string name;//< * on any,. on self,.. on parent
+        std::vector<FrozenPredicate> predicates;
+    };
+    /**
+     * @brief Parse the xpath subset,return false on syntax error
+     * 
+     */
+    inline bool ParseFrozenPath(u8string_view s,bool &absolute,std::vector<FrozenStep> &steps) {
+        size_t i = 0;
+        auto is_name = [](char c){
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == ':' ||
+                   c == '.' || static_cast<unsigned char>(c) >= 0x80;
+        };
+        absolute = !s.empty() && s[0] == '/';
+        bool descendant = false;
+        if(absolute){
+            i = 1;
+            if(i < s.size() && s[i] == '/'){
+                descendant = true;
+                i++;
+            }
+            if(i == s.size() && !descendant){
+                //Only the document node
+                return true;
+            }
+        }
+        while(true){
+            FrozenStep step;
+            step.descendant = descendant;
+            if(i < s.size() && s[i] == '*'){
+                step.name = "*";
+                i++;
+            }
+            else{
+                size_t start = i;
+                while(i < s.size() && is_name(s[i])){
+                    i++;
+                }
+                if(i == start){
+                    return false;
+                }
+                step.name = u8string(s.substr(start,i - start));
+            }
+            while(i < s.size() && s[i] == '['){
+                i++;
+                FrozenPredicate pred {u8string(),u8string(),false,0};
+                if(i < s.size() && s[i] == '@'){
+                    size_t start = ++i;
+                    while(i < s.size() && is_name(s[i])){
+                        i++;
+                    }
+                    if(i == start){
+                        return false;
+                    }
+                    pred.attr = u8string(s.substr(start,i - start));
+                    if(i < s.size() && s[i] == '='){
+                        i++;
+                        if(i >= s.size() || (s[i] != '\'' && s[i] != '"')){
+                            return false;
+                        }
+                        size_t end = s.find(s[i],i + 1);
+                        if(end == u8string_view::npos){
+                            return false;
+                        }
+                        pred.value = u8string(s.substr(i + 1,end - i - 1));
+                        pred.has_value = true;
+                        i = end + 1;
+                    }
+                }
+                else{
+                    size_t start = i;
+                    while(i < s.size() && std::isdigit(static_cast<unsigned char>(s[i]))){
+                        pred.position = pred.position * 10 + (s[i] - '0');
+                        i++;
+                    }
+                    if(i == start || pred.position == 0){
+                        return false;
+                    }
+                }
+                if(i >= s.size() || s[i] != ']'){
+                    return false;
+                }
+                i++;
+                step.predicates.push_back(std::move(pred));
+            }
+            steps.push_back(std::move(step));
+            if(i == s.size()){
+                return true;
+            }
+            if(s[i] != '/'){
+                return false;
+            }
+            i++;
+            descendant = i < s.size() && s[i] == '/';
+            if(descendant){
+                i++;
+            }
+        }
+    }
+}
+inline std::vector<FrozenNode> FrozenNode::query(u8string_view path) const {
+    using Detail::FrozenStep;
+    std::vector<FrozenNode> result;
+    bool absolute;
+    std::vector<FrozenStep> steps;
+    if(is_null() || !Detail::ParseFrozenPath(path,absolute,steps)){
+        return result;
+    }
+    auto &nodes = doc->nodes;
+    std::vector<uint32_t> current {absolute ? 0 : idx};
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> matched;
+    for(auto &step : steps){
+        //Resolve the names once,a missing name matches nothing
+        uint32_t name = FrozenDocument::npos;
+        bool     any = step.name == "*";
+        bool     self = step.name == ".";
+        bool     up = step.name == "..";
+        if(!any && !self && !up){
+            name = doc->name_id(step.name);
+            if(name == FrozenDocument::npos){
+                return result;
+            }
+        }
+        auto match = [&](uint32_t i){
+            return nodes[i].type == XML_ELEMENT_NODE && (any || nodes[i].name == name);
+        };
+        bool positional = false;
+        for(auto &pred : step.predicates){
+            positional = positional || pred.attr.empty();
+        }
+        if(step.descendant && (positional || self || up)){
+            //a//b[n] is a/descendant-or-self::*/b[n],the position counts per parent
+            next.clear();
+            for(uint32_t ctx : current){
+                for(uint32_t i = ctx;i < nodes[ctx].end;i++){
+                    if(i == ctx || nodes[i].type == XML_ELEMENT_NODE){
+                        next.push_back(i);
+                    }
+                }
+            }
+            std::sort(next.begin(),next.end());
+            next.erase(std::unique(next.begin(),next.end()),next.end());
+            current.swap(next);
+        }
+        next.clear();
+        uint32_t covered = 0;
+        for(uint32_t ctx : current){
+            matched.clear();
+            if(self){
+                matched.push_back(ctx);
+            }
+            else if(up){
+                if(nodes[ctx].parent != FrozenDocument::npos){
+                    matched.push_back(nodes[ctx].parent);
+                }
+            }
+            else if(step.descendant && !positional){
+                //The subtree of a nested context was scanned with its ancestor
+                if(ctx < covered){
+                    continue;
+                }
+                covered = nodes[ctx].end;
+                for(uint32_t i = ctx + 1;i < nodes[ctx].end;i++){
+                    if(match(i)){
+                        matched.push_back(i);
+                    }
+                }
+            }
+            else{
+                for(uint32_t i = ctx + 1;i < nodes[ctx].end;i = nodes[i].end){
+                    if(match(i)){
+                        matched.push_back(i);
+                    }
+                }
+            }
+            for(auto &pred : step.predicates){
+                size_t pos = 0;
+                size_t out = 0;
+                for(uint32_t i : matched){
+                    pos++;
+                    bool keep;
+                    if(pred.attr.empty()){
+                        keep = pos == pred.position;
+                    }
+                    else{
+                        FrozenNode node(doc,i);
+                        keep = node.has_attribute(pred.attr) &&
+                               (!pred.has_value || node.attribute_view(pred.attr) == pred.value);
+                    }
+                    if(keep){
+                        matched[out++] = i;
+                    }
+                }
+                matched.resize(out);
+            }
+            next.insert(next.end(),matched.begin(),matched.end());
+        }
+        std::sort(next.begin(),next.end());
+        next.erase(std::unique(next.begin(),next.end()),next.end());
+        current.swap(next);
+        if(current.empty()){
+            return result;
+        }
+    }
+    result.reserve(current.size());
+    for(uint32_t i : current){
+        result.emplace_back(doc,i);
+    }
+    return result;
+}
+inline FrozenNode FrozenNode::query_first(u8string_view path) const {
+    auto nodes = query(path);
+    return nodes.empty() ? FrozenNode() : nodes.front();
+}
+
+LXML_NS_END
+
+//--StructuralIndex
+LXML_NS_BEGIN
+/**
+ * @brief Markup item found by StructuralIndex
+ * 
+ */
+struct StructuralTag {
+    enum Kind : uint8_t {
+        Start,
+        End,
+        Empty,//< <a/>
+        Comment,
+        CData,
+        PI,
+        Doctype,
+    };
+    uint32_t begin;//< Offset of '<'
+    uint32_t end;//< Offset past '>'
+    uint32_t depth;//< Number of the open elements around it,the root is at 0
+    uint32_t match;//< Index of the matching End for Start,its own index otherwise
+    Kind     kind;
+};
+namespace Detail {
+    //The structural bytes: < > " ' &
+    inline bool IsStructural(char c) noexcept {
+        return c == '<' || c == '>' || c == '"' || c == '\'' || c == '&';
+    }
+    /**
+     * @brief Write the offsets of the structural bytes in [begin,end),out needs end - begin + 1 slots
+     * 
+     */
+    inline size_t ScanStructuralScalar(const char *p,size_t begin,size_t end,uint32_t *out) noexcept {
+        size_t n = 0;
+        for(size_t i = begin;i < end;i++){
+            //Branchless,the slot is overwritten if the byte is not structural
+            out[n] = uint32_t(i);
+            n += IsStructural(p[i]);
+        }
+        return n;
+    }
+    inline size_t FlattenBits(uint64_t mask,size_t base,uint32_t *out) noexcept {
+        size_t n = 0;
+        while(mask != 0){
+            out[n++] = uint32_t(base + CountTrailingZeros(mask));
+            mask &= mask - 1;
+        }
+        return n;
+    }
+#if LXML_SIMD_X86
+    //'<' | 2 == '>' and '&' | 1 == '\'',so three compares cover the five bytes
+    inline size_t ScanStructuralSSE2(const char *p,size_t begin,size_t end,uint32_t *out) noexcept {
+        const __m128i two = _mm_set1_epi8(2);
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i gt = _mm_set1_epi8('>');
+        const __m128i sq = _mm_set1_epi8('\'');
+        const __m128i dq = _mm_set1_epi8('"');
+        size_t n = 0;
+        size_t i = begin;
+        for(;i + 16 <= end;i += 16){
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            __m128i m = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(_mm_or_si128(v,two),gt),_mm_cmpeq_epi8(_mm_or_si128(v,one),sq)),
+                _mm_cmpeq_epi8(v,dq)
+            );
+            n += FlattenBits(uint32_t(_mm_movemask_epi8(m)),i,out + n);
+        }
+        return n + ScanStructuralScalar(p,i,end,out + n);
+    }
+    LXML_TARGET_AVX2
+    inline size_t ScanStructuralAVX2(const char *p,size_t begin,size_t end,uint32_t *out) noexcept {
+        const __m256i two = _mm256_set1_epi8(2);
+        const __m256i one = _mm256_set1_epi8(1);
+        const __m256i gt = _mm256_set1_epi8('>');
+        const __m256i sq = _mm256_set1_epi8('\'');
+        const __m256i dq = _mm256_set1_epi8('"');
+        auto classify = [&](__m256i v) LXML_TARGET_AVX2 {
+            __m256i m = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_or_si256(v,two),gt),_mm256_cmpeq_epi8(_mm256_or_si256(v,one),sq)),
+                _mm256_cmpeq_epi8(v,dq)
+            );
+            return uint64_t(uint32_t(_mm256_movemask_epi8(m)));
+        };
+        size_t n = 0;
+        size_t i = begin;
+        for(;i + 64 <= end;i += 64){
+            uint64_t lo = classify(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)));
+            uint64_t hi = classify(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + 32)));
+            uint64_t mask = lo | (hi << 32);
+            while(mask != 0){
+                out[n++] = uint32_t(i + _tzcnt_u64(mask));
+                mask = _blsr_u64(mask);
+            }
+        }
+        return n + ScanStructuralSSE2(p,i,end,out + n);
+    }
+#endif
+}
+/**
+ * @brief Index of the markup of a xml buffer,built without parsing it
+ * 
+ * Stage 1 finds the offsets of < > " ' & with SIMD (AVX2 or SSE2,selected at runtime,scalar fallback),
+ * stage 2 walks the offsets to get the tags,comments,CDATA sections,PIs and the doctype with their depth.
+ * Use it to count elements,skip subtrees or choose chunk boundaries before the real parse.
+ * 
+ * @note It doesn't own the buffer,the input must be less than 4GB. The content is not validated
+ */
+class StructuralIndex {
+    public:
+        enum class Isa {
+            Scalar,
+            SSE2,
+            AVX2,
+        };
+
+        StructuralIndex() = default;
+        StructuralIndex(const StructuralIndex &) = delete;
+        StructuralIndex(StructuralIndex &&) = default;
+        ~StructuralIndex() = default;
+
+        StructuralIndex &operator =(StructuralIndex &&) = default;
+    public:
+        /**
+         * @brief Build the index of the buffer
+         * 
+         * @param isa Instruction set of stage 1,the best one supported by default
+         */
+        static StructuralIndex Build(u8string_view s,Isa isa = Detect()) {
+            LXML_CHECK(s.size() < UINT32_MAX);
+            StructuralIndex index;
+            index.str = s;
+            index.scan(isa);
+            index.link();
+            return index;
+        }
+        /**
+         * @brief Get the best instruction set supported by the cpu
+         * 
+         */
+        static Isa Detect() noexcept {
+#if LXML_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+            static const Isa isa = [](){
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") ? Isa::AVX2 : Isa::SSE2;
+            }();
+            return isa;
+#elif LXML_SIMD_X86
+            return Isa::SSE2;
+#else
+            return Isa::Scalar;
+#endif
+        }
+        //--Stage 1
+        const uint32_t *offsets() const noexcept {
+            return offs.get();
+        }
+        size_t offset_count() const noexcept {
+            return noffsets;
+        }
+        //--Stage 2
+        const std::vector<StructuralTag> &tags() const noexcept {
+            return items;
+        }
+        u8string_view input() const noexcept {
+            return str;
+        }
+        /**
+         * @brief Get the qualified name of a Start / End / Empty tag
+         * 
+         */
+        u8string_view name(const StructuralTag &tag) const noexcept {
+            if(tag.kind != StructuralTag::Start && tag.kind != StructuralTag::End && tag.kind != StructuralTag::Empty){
+                return u8string_view();
+            }
+            size_t begin = tag.begin + (tag.kind == StructuralTag::End ? 2 : 1);
+            size_t end = begin;
+            while(end < tag.end && !Detail::IsNameEnd(str[end])){
+                end++;
+            }
+            return str.substr(begin,end - begin);
+        }
+        /**
+         * @brief Get the index of the tag after the subtree of tags()[i]
+         * 
+         */
+        size_t skip(size_t i) const noexcept {
+            auto &tag = items[i];
+            if(tag.kind == StructuralTag::Start){
+                return tag.match == i ? items.size() : tag.match + 1;
+            }
+            return i + 1;
+        }
+        size_t element_count() const noexcept {
+            return elements;
+        }
+        size_t max_depth() const noexcept {
+            return deepest;
+        }
+        /**
+         * @brief Count the elements with the qualified name
+         * 
+         */
+        size_t count(u8string_view qname) const noexcept {
+            size_t n = 0;
+            for(auto &tag : items){
+                if(tag.kind == StructuralTag::Start || tag.kind == StructuralTag::Empty){
+                    n += name(tag) == qname;
+                }
+            }
+            return n;
+        }
+        /**
+         * @brief Check every start tag has its end tag
+         * 
+         */
+        bool balanced() const noexcept {
+            return is_balanced;
+        }
+        /**
+         * @brief Split the elements at the depth into about parts chunks of the same size
+         * 
+         * @return The offsets of the start tags beginning a new chunk (the first chunk is not included)
+         */
+        std::vector<size_t> boundaries(size_t depth,size_t parts) const {
+            std::vector<size_t> ret;
+            if(parts <= 1 || str.empty()){
+                return ret;
+            }
+            size_t step = str.size() / parts;
+            size_t next = step;
+            for(size_t i = 0;i < items.size();){
+                auto &tag = items[i];
+                if(tag.depth == depth && (tag.kind == StructuralTag::Start || tag.kind == StructuralTag::Empty)){
+                    if(tag.begin >= next){
+                        ret.push_back(tag.begin);
+                        next = tag.begin + step;
+                    }
+                    //Nothing inside could be at the depth
+                    i = skip(i);
+                    continue;
+                }
+                i++;
+            }
+            return ret;
+        }
+    private:
+        void scan(Isa isa) {
+            //Scan in windows,the buffer grows ahead of the window so the scanners write without checks
+            const size_t window = 1 << 16;
+            const char  *p = str.data();
+            for(size_t begin = 0;begin < str.size();begin += window){
+                size_t end = begin + window < str.size() ? begin + window : str.size();
+                reserve(noffsets + (end - begin) + 1);
+                switch(isa){
+#if LXML_SIMD_X86
+                    case Isa::AVX2 : noffsets += Detail::ScanStructuralAVX2(p,begin,end,offs.get() + noffsets); break;
+                    case Isa::SSE2 : noffsets += Detail::ScanStructuralSSE2(p,begin,end,offs.get() + noffsets); break;
+#endif
+                    default : noffsets += Detail::ScanStructuralScalar(p,begin,end,offs.get() + noffsets); break;
+                }
+            }
+        }
+        void reserve(size_t n) {
+            if(n <= capacity){
+                return;
+            }
+            size_t cap = capacity * 2 > n ? capacity * 2 : n;
+            std::unique_ptr<uint32_t[]> buf(new uint32_t[cap]);
+            if(noffsets != 0){
+                std::memcpy(buf.get(),offs.get(),noffsets * sizeof(uint32_t));
+            }
+            offs = std::move(buf);
+            capacity = cap;
+        }
+        //Comment,CDATA,doctype or PI at the offset,return the end
+        size_t markup(size_t at,StructuralTag &tag) const noexcept {
+            u8string_view rest = str.substr(at);
+            if(rest.compare(0,4,"<!--") == 0){
+                tag.kind = StructuralTag::Comment;
+                return Detail::FindText(str,at + 4,"-->");
+            }
+            if(rest.compare(0,9,"<![CDATA[") == 0){
+                tag.kind = StructuralTag::CData;
+                return Detail::FindText(str,at + 9,"]]>");
+            }
+            if(rest.compare(0,2,"<!") == 0){
+                tag.kind = StructuralTag::Doctype;
+                return Detail::FindDoctypeEnd(str,at + 2);
+            }
+            tag.kind = StructuralTag::PI;
+            return Detail::FindText(str,at + 2,"?>");
+        }
+        void link() {
+            const char *p = str.data();
+            size_t      n = str.size();
+            const uint32_t *o = offs.get();
+            std::vector<uint32_t> open;
+            bool unmatched = false;
+            //About 3 offsets per tag on usual documents
+            items.reserve(noffsets / 3 + 1);
+            size_t i = 0;
+            while(i < noffsets){
+                uint32_t at = o[i];
+                if(p[at] != '<'){
+                    i++;
+                    continue;
+                }
+                StructuralTag tag;
+                tag.begin = at;
+                char   first = at + 1 < n ? p[at + 1] : '\0';
+                size_t end;
+                if(first == '!' || first == '?'){
+                    end = markup(at,tag);
+                }
+                else{
+                    //Find the '>' in the offsets,skipping the quoted values
+                    end = n;
+                    size_t j = i + 1;
+                    while(j < noffsets){
+                        char c = p[o[j]];
+                        if(c == '>'){
+                            end = o[j] + 1;
+                            break;
+                        }
+                        if(c == '<'){
+                            //Unclosed tag
+                            end = o[j];
+                            break;
+                        }
+                        if(c == '"' || c == '\''){
+                            j++;
+                            while(j < noffsets && p[o[j]] != c){
+                                j++;
+                            }
+                        }
+                        j++;
+                    }
+                    if(first == '/'){
+                        tag.kind = StructuralTag::End;
+                    }
+                    else if(end >= at + 2 && p[end - 1] == '>' && p[end - 2] == '/'){
+                        tag.kind = StructuralTag::Empty;
+                    }
+                    else{
+                        tag.kind = StructuralTag::Start;
+                    }
+                }
+                if(end > n){
+                    end = n;
+                }
+                tag.end = uint32_t(end);
+                tag.match = uint32_t(items.size());
+                if(tag.kind == StructuralTag::End){
+                    if(open.empty()){
+                        unmatched = true;
+                        tag.depth = 0;
+                    }
+                    else{
+                        tag.depth = uint32_t(open.size() - 1);
+                        items[open.back()].match = uint32_t(items.size());
+                        open.pop_back();
+                    }
+                }
+                else{
+                    tag.depth = uint32_t(open.size());
+                }
+                if(tag.kind == StructuralTag::Start || tag.kind == StructuralTag::Empty){
+                    elements++;
+                    deepest = tag.depth + 1 > deepest ? tag.depth + 1 : deepest;
+                }
+                if(tag.kind == StructuralTag::Start){
+                    open.push_back(uint32_t(items.size()));
+                }
+                items.push_back(tag);
+                while(i < noffsets && o[i] < end){
+                    i++;
+                }
+            }
+            is_balanced = open.empty() && !unmatched;
+        }
+
+        u8string_view               str;
+        std::unique_ptr<uint32_t[]> offs;
+        size_t                      noffsets = 0;
+        size_t                      capacity = 0;
+        std::vector<StructuralTag>  items;
+        size_t                      elements = 0;
+        size_t                      deepest = 0;
+        bool                        is_balanced = false;
+};
+
+LXML_NS_END
+
+//--Impl NodeRef::xpath_first
+LXML_NS_BEGIN
+namespace Detail {
+    /**
+     * @brief Native evaluator of the xpath subset of FrozenDocument on the DOM:
+     *        child / descendant steps,name tests without prefix,[@attr],[@attr='value'] and [n]
+     * 
+     * The candidates are walked in document order and matched right to left,so the first match is the first
+     * node of the node-set and the walk stops there.
+     * A path out of the subset keeps the libxml2 expression instead,so it is cached too and not parsed again.
+     */
+    class NativePath {
+        public:
+            bool is_null() const noexcept {
+                return false;
+            }
+            bool is_native() const noexcept {
+                return !steps.empty();
+            }
+            /**
+             * @brief Get the libxml2 expression of a path out of the subset
+             * 
+             * @return const XPathExpression& (null on syntax error or a native path)
+             */
+            const XPathExpression &fallback() const noexcept {
+                return expr;
+            }
+            /**
+             * @brief Get the first matching element in document order,node is the context of a relative path
+             * 
+             * @return const xmlNode* (nullptr on none)
+             */
+            const xmlNode *first(const xmlNode *node) const noexcept {
+                const xmlNode *ctx = absolute ? reinterpret_cast<const xmlNode*>(node->doc) : node;
+                if(ctx == nullptr){
+                    return nullptr;
+                }
+                size_t n = steps.size();
+                //Without // the matches are exactly n levels down
+                bool   deep = false;
+                for(auto &step : steps){
+                    deep = deep || step.descendant;
+                }
+                const xmlNode *cur = ctx->children;
+                size_t         depth = 1;
+                while(cur != nullptr){
+                    if(cur->type == XML_ELEMENT_NODE){
+                        if((deep || depth == n) && match(cur,n - 1,ctx)){
+                            return cur;
+                        }
+                        if((deep || depth < n) && cur->children != nullptr){
+                            cur = cur->children;
+                            depth++;
+                            continue;
+                        }
+                    }
+                    while(cur->next == nullptr){
+                        cur = cur->parent;
+                        depth--;
+                        if(cur == ctx || cur == nullptr){
+                            return nullptr;
+                        }
+                    }
+                    cur = cur->next;
+                }
+                return nullptr;
+            }
+            /**
+             * @brief Compile the path
+             * 
+             * @return NativePath (compiled by libxml2 if it is out of the subset)
+             */
+            static NativePath Compile(u8string_view s) {
+                NativePath path;
+                if(!ParseFrozenPath(s,path.absolute,path.steps)){
+                    path.steps.clear();
+                }
+                //A name starts with a letter,'_' or a non ascii char,"1" or "-1" is a number for libxml2
+                auto is_name = [](const u8string &name){
+                    unsigned char c = name.empty() ? 0 : static_cast<unsigned char>(name[0]);
+                    return std::isalpha(c) || c == '_' || c >= 0x80;
+                };
+                for(auto &step : path.steps){
+                    bool prefixed = step.name.find(':') != u8string::npos;
+                    bool named = step.name == "*" || is_name(step.name);
+                    for(auto &pred : step.predicates){
+                        prefixed = prefixed || pred.attr.find(':') != u8string::npos;
+                        named = named && (pred.attr.empty() || is_name(pred.attr));
+                    }
+                    if(prefixed || !named){
+                        path.steps.clear();
+                        break;
+                    }
+                }
+                if(path.steps.empty()){
+                    path.expr = XPathExpression::Compile(s);
+                }
+                return path;
+            }
+        private:
+            //Match the node against steps[k] and its ancestors against the steps before
+            bool match(const xmlNode *node,size_t k,const xmlNode *ctx) const noexcept {
+                auto &step = steps[k];
+                if(!test(node,step,step.predicates.size())){
+                    return false;
+                }
+                if(k == 0){
+                    //The candidates are all under ctx
+                    return step.descendant || node->parent == ctx;
+                }
+                if(step.descendant){
+                    for(const xmlNode *p = node->parent;p != nullptr && p != ctx;p = p->parent){
+                        if(match(p,k - 1,ctx)){
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+                return node->parent != ctx && node->parent != nullptr && match(node->parent,k - 1,ctx);
+            }
+            //Name test and the first npred predicates
+            static bool test(const xmlNode *node,const FrozenStep &step,size_t npred) noexcept {
+                if(node->type != XML_ELEMENT_NODE){
+                    return false;
+                }
+                if(step.name != "*" && (node->ns != nullptr || !NameEquals(node->name,step.name))){
+                    return false;
+                }
+                for(size_t i = 0;i < npred;i++){
+                    auto &pred = step.predicates[i];
+                    if(pred.attr.empty()){
+                        //The position among the siblings passing the test so far
+                        size_t pos = 1;
+                        for(const xmlNode *s = node->prev;s != nullptr && pos <= pred.position;s = s->prev){
+                            pos += test(s,step,i);
+                        }
+                        if(pos != pred.position){
+                            return false;
+                        }
+                        continue;
+                    }
+                    const xmlAttr *attr = node->properties;
+                    while(attr != nullptr && (attr->ns != nullptr || !NameEquals(attr->name,pred.attr))){
+                        attr = attr->next;
+                    }
+                    if(attr == nullptr){
+                        return false;
+                    }
+                    if(pred.has_value){
+                        u8string_view value;
+                        if(AttributeView(attr,value)){
+                            if(value != pred.value){
+                                return false;
+                            }
+                        }
+                        else{
+                            lstring str(xmlNodeListGetString(node->doc,attr->children,1));
+                            if(str.view() != pred.value){
+                                return false;
+                            }
+                        }
+                    }
+                }
+                return true;
+            }
+
+            std::vector<FrozenStep> steps;
+            bool                    absolute = false;
+            XPathExpression         expr;
+    };
+    inline CompileCache<NativePath> &NativePathCache() {
+        static CompileCache<NativePath> cache;
+        return cache;
+    }
+}
+
+inline NodeRef NodeRef::xpath_first(u8string_view s) const {
+    auto path = Detail::NativePathCache().get(s);
+    if(path->is_native()){
+        return NodeRef(const_cast<xmlNode*>(path->first(node)));
+    }
+    //On syntax error evaluate the text,so libxml2 reports it
+    auto obj = path->fallback().is_null() ? xpath(s) : XPathContent::Local(document()).eval(*this,path->fallback());
+    if(obj.is_null() || !obj.is_nodeset()){
+        return NodeRef();
+    }
+    auto set = obj.as_nodeset();
+    return set.size() == 0 ? NodeRef() : set[0];
+}
+inline bool NodeRef::xpath_exists(u8string_view s) const {
+    auto path = Detail::NativePathCache().get(s);
+    if(path->is_native()){
+        return path->first(node) != nullptr;
+    }
+    auto obj = path->fallback().is_null() ? xpath(s) : XPathContent::Local(document()).eval(*this,path->fallback());
+    return !obj.is_null() && xmlXPathCastToBoolean(obj.get());
+}
+
+LXML_NS_END
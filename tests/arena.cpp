@@ -0,0 +1,45 @@
+#include "test.hpp"
+#include <type_traits>
+
+//The arena document can't become a plain one,xmlFreeDoc would run on the arena memory
+static_assert(!std::is_constructible<LXml::XmlDocument,LXml::XmlArenaDocument &&>::value,"");
+static_assert(!std::is_convertible<LXml::XmlArenaDocument &,LXml::Document &>::value,"");
+static_assert(!std::is_convertible<LXml::XmlArenaDocument &,LXml::DocumentRef>::value,"");
+
+//Arena::Install() is process wide,the tests run without it: the documents use the heap with the same api
+TEST_GROUP(arena) {
+    LXml::Arena arena;
+    {
+        LXml::ArenaScope scope(arena);
+        void *p = xmlMalloc(24);
+        CHECK(p != nullptr);
+        xmlFree(p);
+    }
+    CHECK(LXml::Arena::Current() == nullptr);
+
+    auto doc = LXml::XmlArenaDocument::Parse("<r><a>1</a><a>2</a></r>");
+    CHECK(doc.get_arena() != nullptr);
+    CHECK(doc.root_node().name_view() == "r");
+    CHECK(doc.freeze().query("//a").size() == 2);
+    CHECK(doc.ref().get() == doc.get());
+
+    LXml::XmlArenaDocument moved;
+    moved = std::move(doc);
+    CHECK(doc.get() == nullptr);
+    CHECK(moved.root_node().select_first("a").content() == "1");
+
+    auto built = LXml::XmlArenaDocument::New();
+    {
+        LXml::DocumentBuilder builder(built);
+        builder.start_element("rows");
+        builder.start_element("row");
+        builder.attribute("id",7);
+        builder.text("x");
+        builder.end_element();
+        builder.end_element();
+        //Current only around the allocations,the xpath contexts of the thread stay on the heap
+        CHECK(LXml::Arena::Current() == nullptr);
+    }
+    CHECK(built.root_node().select_first("row").attribute("id") == "7");
+    CHECK(built.to_string(false).find("<rows><row id=\"7\">x</row></rows>") != LXml::u8string::npos);
+}
@@ -0,0 +1,142 @@
+#include "test.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+TEST_GROUP(batch) {
+    std::vector<std::string> inputs;
+    for(size_t i = 0;i < 64;i++){
+        if(i % 16 == 5){
+            inputs.push_back("<r><item>" + std::to_string(i) + "</item>");
+        }
+        else{
+            inputs.push_back("<r><item>" + std::to_string(i) + "</item></r>");
+        }
+    }
+    std::vector<LXml::u8string_view> views(inputs.begin(),inputs.end());
+
+    for(size_t threads : {1,4}){
+        auto results = LXml::ParseBatch(views,threads);
+        CHECK(results.size() == inputs.size());
+        size_t ok = 0;
+        size_t recovered = 0;
+        for(size_t i = 0;i < results.size();i++){
+            auto &result = results[i];
+            //Recover keeps the broken documents,the error is reported as warning
+            CHECK(result.ok());
+            CHECK(result.document.root_node().select_first("item").content() == std::to_string(i));
+            ok += result.warning.empty();
+            recovered += !result.warning.empty();
+        }
+        CHECK(ok == 60);
+        CHECK(recovered == 4);
+    }
+
+    auto strict = LXml::ParseBatch(views,4,LXml::NoError | LXml::NoWarning);
+    size_t failed = 0;
+    for(auto &result : strict){
+        failed += !result.ok();
+        CHECK(result.ok() == result.error.empty());
+    }
+    CHECK(failed == 4);
+    CHECK(!strict[5].error.empty());
+    CHECK(strict[5].document.get() == nullptr);
+    CHECK(LXml::ParseBatch(std::vector<LXml::u8string_view>()).empty());
+}
+
+TEST_GROUP(records) {
+    std::string xml = "<?xml version='1.0'?><!DOCTYPE feed [<!ENTITY e 'E'>]><feed xmlns:p='urn:p'>";
+    for(size_t i = 0;i < 2000;i++){
+        xml += "<p:entry n='" + std::to_string(i) + "'>&e;<t>" + std::to_string(i) + "</t></p:entry><other/>";
+    }
+    xml += "</feed>";
+
+    std::mutex        mutex;
+    std::vector<bool> seen(2000);
+    size_t            mismatched = 0;
+    size_t n = LXml::ParseRecords(xml,"p:entry",[&](LXml::NodeRef record,size_t index){
+        std::lock_guard<std::mutex> locker(mutex);
+        seen[index] = true;
+        mismatched += record.attribute("n") != std::to_string(index);
+        mismatched += record.select_first("t").content() != std::to_string(index);
+    },4);
+    CHECK(n == 2000);
+    CHECK(mismatched == 0);
+    CHECK(std::find(seen.begin(),seen.end(),false) == seen.end());
+
+    //The exception of a worker reaches the caller after all of them stopped
+    std::atomic<size_t> calls {0};
+    bool caught = false;
+    try{
+        LXml::ParseRecords(xml,"p:entry",[&](LXml::NodeRef,size_t index){
+            calls++;
+            if(index == 1000){
+                throw std::runtime_error("record 1000");
+            }
+        },4);
+    }
+    catch(std::runtime_error &err){
+        caught = std::string(err.what()) == "record 1000";
+    }
+    CHECK(caught);
+    CHECK(calls.load() <= 2000);
+
+    //Not understood by the prescan (no end tag),parsed on the calling thread
+    size_t fallback = LXml::ParseRecords("<r><a/><a/>","a",[](LXml::NodeRef,size_t){},4);
+    CHECK(fallback == 2);
+}
+
+//A chunk that fails to parse is reported,not dropped
+TEST_GROUP(records_errors) {
+    std::string xml = "<feed>";
+    for(size_t i = 0;i < 2000;i++){
+        xml += i == 1000 ? "<entry n='1000'><t>a & b</t></entry>" : "<entry n='" + std::to_string(i) + "'><t/></entry>";
+    }
+    xml += "</feed>";
+
+    std::atomic<size_t> calls {0};
+    std::vector<LXml::RecordError> errors;
+    size_t n = LXml::ParseRecords(xml,"entry",[&](LXml::NodeRef,size_t){ calls++; },4,LXml::NoError | LXml::NoWarning,&errors);
+    CHECK(n == calls.load());
+    CHECK(errors.size() == 1);
+    CHECK(!errors.empty() && errors[0].first <= 1000 && errors[0].last > 1000);
+    CHECK(!errors.empty() && !errors[0].error.empty());
+    CHECK(!errors.empty() && n + (errors[0].last - errors[0].first) == 2000);
+
+    bool caught = false;
+    try{
+        LXml::ParseRecords(xml,"entry",[](LXml::NodeRef,size_t){},4,LXml::NoError | LXml::NoWarning);
+    }
+    catch(std::runtime_error &){
+        caught = true;
+    }
+    CHECK(caught);
+
+    //Recovered by default,every record is handed out
+    errors.clear();
+    CHECK(LXml::ParseRecords(xml,"entry",[](LXml::NodeRef,size_t){},4,LXml::DefaultOptions,&errors) == 2000);
+    CHECK(errors.empty());
+
+    //The whole document on the calling thread
+    errors.clear();
+    CHECK(LXml::ParseRecords("<r><a/><a>","a",[](LXml::NodeRef,size_t){},4,LXml::NoError | LXml::NoWarning,&errors) == 0);
+    CHECK(errors.size() == 1);
+    CHECK(!errors.empty() && errors[0].first == 0 && errors[0].last == 0);
+
+    //A missing file is not an empty one
+    errors.clear();
+    const char *missing = "/tmp/lxml_tests_missing_records.xml";
+    CHECK(LXml::ParseRecordsFile(missing,"a",[](LXml::NodeRef,size_t){},4,LXml::DefaultOptions,&errors) == 0);
+    CHECK(errors.size() == 1);
+    CHECK(!errors.empty() && errors[0].error.find(missing) != LXml::u8string::npos);
+    caught = false;
+    try{
+        LXml::ParseRecordsFile(missing,"a",[](LXml::NodeRef,size_t){});
+    }
+    catch(std::runtime_error &){
+        caught = true;
+    }
+    CHECK(caught);
+}
@@ -0,0 +1,84 @@
+#include "test.hpp"
+
+namespace {
+
+struct Author {
+    std::string name;
+    int         born = 0;
+
+    static constexpr auto lxml_binding = LXml::Binding(
+        LXml::BindText(&Author::name),
+        LXml::BindAttribute("born",&Author::born)
+    );
+};
+struct Book {
+    int                      id = -1;
+    bool                     available = false;
+    double                   price = 0;
+    long long                pages = 0;
+    std::string              title;
+    std::string              note;
+    std::vector<std::string> tags;
+    Author                   author;
+
+    static constexpr auto lxml_binding = LXml::Binding(
+        LXml::BindAttribute("id",&Book::id),
+        LXml::BindAttribute("available",&Book::available),
+        LXml::BindAttribute("note",&Book::note),
+        LXml::BindElement("title",&Book::title),
+        LXml::BindElement("price",&Book::price),
+        LXml::BindElement("pages",&Book::pages),
+        LXml::BindElement("tag",&Book::tags),
+        LXml::BindElement("author",&Book::author)
+    );
+};
+
+const char *books =
+    "<!DOCTYPE books [<!ENTITY e 'E'>]>"
+    "<books>"
+    "<book id=' 42 ' available='true' note='x&e;y'>"
+    "<title>Hello<!--c--> World</title><price> 12.5 </price><pages>123456789012</pages>"
+    "<tag>a</tag><tag>b &amp; c</tag><author born='1950'>Ann</author><title>second</title>"
+    "</book>"
+    "<book id='x'><title>Only &e;</title></book>"
+    "</books>";
+
+}
+
+TEST_GROUP(bind) {
+    auto doc  = LXml::XmlDocument::Parse(books);
+    auto book = doc.root_node().first_child();
+
+    Book b;
+    CHECK(LXml::Bind(book,b));
+    CHECK(b.id == 42);
+    CHECK(b.available);
+    CHECK(b.price == 12.5);
+    CHECK(b.pages == 123456789012LL);
+    //Mixed content and entities go through the owning copy
+    CHECK(b.title == "Hello World");
+    CHECK(b.note == "xEy");
+    CHECK(b.tags.size() == 2 && b.tags[0] == "a" && b.tags[1] == "b & c");
+    CHECK(b.author.name == "Ann" && b.author.born == 1950);
+
+    //A malformed number keeps the member and reports false
+    Book bad;
+    CHECK(!LXml::Bind(book.next_sibling(),bad));
+    CHECK(bad.id == -1);
+    CHECK(bad.title == "Only E");
+    CHECK(LXml::Bind<Book>(book.next_sibling()).title == "Only E");
+    CHECK(!LXml::Bind(LXml::NodeRef(),bad));
+
+    //Streaming,the entities are substituted by the reader
+    std::string xml = "<books><book id='1'><title>A</title></book><book id='2'><title>B&amp;C</title></book><book id='z'/></books>";
+    auto reader = LXml::XmlReader::Parse(xml);
+    std::vector<Book> list;
+    size_t failed = 0;
+    size_t n = LXml::BindEach<Book>(reader,"book",[&](Book &&value,bool ok){
+        failed += !ok;
+        list.push_back(std::move(value));
+    });
+    CHECK(n == 3 && list.size() == 3);
+    CHECK(list[1].id == 2 && list[1].title == "B&C");
+    CHECK(failed == 1);
+}
@@ -0,0 +1,117 @@
+#include "test.hpp"
+#include <string>
+
+TEST_GROUP(attributes) {
+    auto doc = LXml::XmlDocument::Parse("<r xmlns:p='urn:p' a='1' p:b='2' c='x&amp;y' d=''/>");
+    auto root = doc.root_node();
+    std::string names;
+    std::string values;
+    for(auto attr : root.attributes()){
+        names += std::string(attr.name) + ",";
+        values += std::string(attr.value) + ",";
+    }
+    CHECK(names == "a,b,c,d,");
+    CHECK(values == "1,2,x&y,,");
+    CHECK(root.has_attribute("b"));
+    CHECK(root.has_attribute("d"));
+    CHECK(!root.has_attribute("e"));
+    CHECK(root.attribute_view("a") == "1");
+    CHECK(root.attribute_view("e").empty());
+    CHECK(root.find_attribute("c") != nullptr);
+    CHECK(root.attributes().begin() != root.attributes().end());
+    CHECK(root.first_child().is_null());
+}
+
+TEST_GROUP(names) {
+    auto doc = LXml::XmlDocument::Parse("<r><item/><other/><item/><item>t</item></r>");
+    auto root = doc.root_node();
+    auto item = doc.intern("item");
+    CHECK(item.is_interned());
+    CHECK(item.match(root.first_child().get()->name));
+    CHECK(!item.match(root.first_child().next_sibling().get()->name));
+    size_t n = 0;
+    for(auto node : root.children_named(item)){
+        n += node.name_view() == "item";
+    }
+    CHECK(n == 3);
+    //Not in the dict,it isn't added and nothing matches
+    int dict = xmlDictSize(doc.get()->dict);
+    auto missing = doc.intern("missing");
+    CHECK(!missing.is_interned());
+    CHECK(xmlDictSize(doc.get()->dict) == dict);
+    size_t none = 0;
+    for(auto node : root.children_named(missing)){
+        none += !node.is_null();
+    }
+    CHECK(none == 0);
+    //The view of an interned name is the string of the dict
+    LXml::Name other(doc,std::string("other"));
+    CHECK(other.is_interned());
+    CHECK(other.view() == "other");
+    CHECK(other.view().data() == reinterpret_cast<const char*>(other.get()));
+}
+
+TEST_GROUP(iterators) {
+    auto doc = LXml::XmlDocument::Parse("<r>a<x><y/>b<z><y/></z></x><!--c--><y/></r>");
+    auto root = doc.root_node();
+    std::string order;
+    for(auto node : root.descendants()){
+        order += std::string(node.name_view());
+    }
+    CHECK(order == "xyzyy");
+    std::string children;
+    for(auto node : root.elements()){
+        children += std::string(node.name_view());
+    }
+    CHECK(children == "xy");
+    size_t ys = 0;
+    for(auto node : root.descendants([](const LXml::NodeRef &node){ return node.name_view() == "y"; })){
+        ys += node.name_view() == "y";
+    }
+    CHECK(ys == 3);
+    size_t all = 0;
+    for(auto node : root.children()){
+        all += !node.is_null();
+    }
+    CHECK(all == 4);
+    CHECK(root.select_first("z").descendants().begin() != root.select_first("z").descendants().end());
+    CHECK(root.select_first("z > y").descendants().begin() == root.select_first("z > y").descendants().end());
+}
+
+TEST_GROUP(path_query) {
+    auto doc = LXml::XmlDocument::Parse(
+        "<feed><entry><link href='1'/><link href='2'/></entry><other><link href='x'/></other>"
+        "<entry><title/><link href='3'/></entry></feed>"
+    );
+    constexpr auto links = LXml::Path("feed") / "entry" / "link";
+    static_assert(links.size() == 3,"");
+    std::string hrefs;
+    for(auto link : links.all(doc)){
+        hrefs += std::string(link.attribute_view("href"));
+    }
+    CHECK(hrefs == "123");
+    CHECK(links.first(doc).attribute_view("href") == "1");
+    CHECK((LXml::Path("feed") / "*" / "link").first(doc).attribute_view("href") == "1");
+    CHECK((LXml::Path("entry") / "title").first(doc.root_node()).name_view() == "title");
+    CHECK((LXml::Path("feed") / "missing").all(doc).empty());
+    CHECK(LXml::Path("entry").first(doc).is_null());
+
+#if LXML_CXX20
+    //Names as template arguments,same matches as the runtime steps
+    constexpr auto fixed = LXml::path<"feed","entry","link">;
+    static_assert(fixed.size() == 3 && fixed[1] == "entry","");
+    std::string fixed_hrefs;
+    for(auto link : fixed.all(doc)){
+        fixed_hrefs += std::string(link.attribute_view("href"));
+    }
+    CHECK(fixed_hrefs == "123");
+    CHECK(fixed.first(doc).attribute_view("href") == "1");
+    CHECK((LXml::path<"feed","*","link">.first(doc).attribute_view("href") == "1"));
+    CHECK((LXml::path<"entry","title">.first(doc.root_node()).name_view() == "title"));
+    //Prefixes and longer names don't match
+    CHECK((LXml::path<"fee">.first(doc).is_null()));
+    CHECK((LXml::path<"feeds">.first(doc).is_null()));
+    CHECK((LXml::path<"feed","entr">.all(doc).empty()));
+    CHECK((LXml::path<"feed","missing">.all(doc).empty()));
+#endif
+}
@@ -0,0 +1,89 @@
+#include "test.hpp"
+#include <unordered_map>
+
+namespace {
+
+//Index of every element in document order,the same on the DOM and the frozen copy
+void Number(xmlNode *node,std::unordered_map<xmlNode *,size_t> &out) {
+    for(;node != nullptr;node = node->next){
+        if(node->type == XML_ELEMENT_NODE){
+            out.emplace(node,out.size());
+            Number(node->children,out);
+        }
+    }
+}
+
+}
+
+TEST_GROUP(frozen) {
+    auto doc = LXml::XmlDocument::Parse(
+        "<!DOCTYPE lib [<!ENTITY pub 'Acme'>]>"
+        "<lib>"
+        "<book id='1' lang='en' by='x&pub;y'><title>One</title><author>A</author></book>"
+        "<book id='2'><title>Two</title><author>B</author><author>C</author></book>"
+        "<shelf><book id='3' lang='fr'><title>Three</title></book><note>n<!--c--></note></shelf>"
+        "<book id='4' by='a&amp;b'><title>Four</title></book>"
+        "</lib>"
+    );
+    auto frozen = doc.freeze();
+    CHECK(!frozen.empty());
+    CHECK(frozen.root_node().name_view() == "lib");
+
+    std::unordered_map<xmlNode *,size_t> dom;
+    Number(doc.get()->children,dom);
+    std::unordered_map<uint32_t,size_t> flat;
+    for(auto node : frozen.document().descendants()){
+        flat.emplace(node.index(),flat.size());
+    }
+    CHECK(dom.size() == flat.size());
+
+    //Pairs of frozen path and reference xpath (nullptr on the same),
+    //libxml2 compares entity valued attributes by a hash of the first text node,concat() forces the full value
+    const char *paths[][2] = {
+        {"/lib",nullptr},
+        {"/lib/book",nullptr},
+        {"//book",nullptr},
+        {"//title",nullptr},
+        {"/lib/*",nullptr},
+        {"//book/title",nullptr},
+        {"//shelf//title",nullptr},
+        {"//book[@lang]",nullptr},
+        {"//book[@lang='fr']",nullptr},
+        {"//book[@by='xAcmey']","//book[concat(@by,'')='xAcmey']"},
+        {"//book[@by='a&b']",nullptr},
+        {"//book[2]",nullptr},
+        {"/lib/book[3]/title",nullptr},
+        {"//author[2]",nullptr},
+        {"//title/..",nullptr},
+        {"//book/.",nullptr},
+        {"//missing",nullptr},
+        {"/book",nullptr},
+    };
+    for(auto &pair : paths){
+        const char *path = pair[0];
+        std::vector<size_t> expected;
+        for(auto node : doc.root_node().xpath(pair[1] != nullptr ? pair[1] : path)){
+            expected.push_back(dom.at(node.get()));
+        }
+        std::vector<size_t> got;
+        for(auto node : frozen.query(path)){
+            got.push_back(flat.at(node.index()));
+        }
+        if(!CHECK(got == expected)){
+            std::printf("  path: %s\n",path);
+        }
+    }
+
+    auto book = frozen.query_first("//book[@id='1']");
+    CHECK(book.attribute_view("by") == "xAcmey");
+    CHECK(frozen.query_first("//book[@id='4']").attribute_view("by") == "a&b");
+    CHECK(book.first_child().content() == "One");
+    CHECK(frozen.query_first("//note").content() == "n");
+    CHECK(frozen.query("//book[").empty());
+
+    //The snapshot doesn't refer to the source
+    auto moved = std::move(frozen);
+    CHECK(moved.query("//book").size() == 4);
+    CHECK(moved.name_id("book") != LXml::FrozenDocument::npos);
+    CHECK(moved.name_id("nothing") == LXml::FrozenDocument::npos);
+}
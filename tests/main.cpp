@@ -0,0 +1,22 @@
+#include "test.hpp"
+#include <cstring>
+
+//Keep the output to the check results,the error cases are expected
+static void Quiet(void *,const char *,...) {}
+
+//Usage: tests [filter],only the groups whose name contains filter are run
+int main(int argc,char **argv){
+    LXml::Library lib;
+    xmlSetGenericErrorFunc(nullptr,Quiet);
+
+    for(auto &group : Test::Groups()){
+        if(argc > 1 && std::strstr(group.first,argv[1]) == nullptr){
+            continue;
+        }
+        size_t before = Test::Failures();
+        group.second();
+        std::printf("%-12s %s\n",group.first,Test::Failures() == before ? "ok" : "FAILED");
+    }
+    std::printf("%zu checks,%zu failed\n",Test::Checks(),Test::Failures());
+    return Test::Failures() == 0 ? 0 : 1;
+}
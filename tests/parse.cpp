@@ -0,0 +1,164 @@
+#include "test.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::string Records(size_t n) {
+    std::string xml = "<?xml version='1.0'?><root>";
+    for(size_t i = 0;i < n;i++){
+        xml += "<item id='" + std::to_string(i) + "'><name>n" + std::to_string(i) + "</name><!-- c --></item>";
+    }
+    xml += "</root>";
+    return xml;
+}
+
+}
+
+TEST_GROUP(parse_file) {
+    const char *path = "/tmp/lxml_tests_parse.xml";
+    auto xml = Records(2000);
+    {
+        std::ofstream file(path);
+        file << xml;
+    }
+    auto doc = LXml::XmlDocument::ParseFile(path);
+    CHECK(doc.root_node().name_view() == "root");
+    CHECK(doc.freeze().query("/root/item").size() == 2000);
+    CHECK(doc.get()->URL != nullptr);
+
+    size_t items = 0;
+    auto reader = LXml::XmlReader::ParseFile(path);
+    while(reader.next_element("item")){
+        auto node = reader.expand();
+        items += node.attribute("id") == std::to_string(items);
+    }
+    CHECK(items == 2000);
+    CHECK(!reader.has_error());
+    std::remove(path);
+
+    bool failed = false;
+    try{
+        LXml::XmlDocument::ParseFile("/tmp/lxml_tests_missing.xml");
+    }
+    catch(std::runtime_error &){
+        failed = true;
+    }
+    CHECK(failed);
+}
+
+TEST_GROUP(reader) {
+    auto xml = Records(3);
+    auto reader = LXml::XmlReader::Parse(xml);
+    size_t elements = 0;
+    size_t ends = 0;
+    std::string text;
+    while(reader.read()){
+        elements += reader.is_element();
+        ends += reader.is_end_element();
+        if(reader.is_text()){
+            text += std::string(reader.value_view());
+        }
+    }
+    CHECK(elements == 7);
+    CHECK(ends == 7);
+    CHECK(text == "n0n1n2");
+
+    //Skipping the subtrees
+    auto skipping = LXml::XmlReader::Parse(xml);
+    CHECK(skipping.read());
+    CHECK(skipping.name_view() == "root");
+    CHECK(skipping.read());
+    size_t siblings = 0;
+    do{
+        siblings += skipping.is_element() && skipping.name_view() == "item";
+    }
+    while(skipping.next());
+    CHECK(siblings == 3);
+
+    //The name is a view,not a NUL terminated string
+    auto attrs = LXml::XmlReader::Parse("<r id='1' idx='2'/>");
+    CHECK(attrs.read());
+    CHECK(attrs.attribute(LXml::u8string_view("idx",2)) == "1");
+    CHECK(attrs.attribute(LXml::u8string_view("idx",3)) == "2");
+    CHECK(attrs.attribute("missing").is_null());
+}
+
+TEST_GROUP(parser_context) {
+    LXml::ParserContext<LXml::XmlDocument> ctxt;
+    auto first = ctxt.parse("<r><item/></r>");
+    auto second = ctxt.parse("<r><item/><other/></r>");
+    CHECK(first.root_node().first_child().name_view() == "item");
+    CHECK(second.root_node().select_first("other").name_view() == "other");
+    //The names are shared through the dict of the context
+    CHECK(first.root_node().get()->name == second.root_node().get()->name);
+    CHECK(ctxt.dict_size() >= 3);
+    ctxt.reset_dict();
+    auto third = ctxt.parse("<r/>");
+    CHECK(third.root_node().name_view() == "r");
+    //The documents outlive the context
+    LXml::ParserContext<LXml::HtmlDocument> html;
+    auto page = html.parse("<p class='a'>x</p>");
+    CHECK(page.root_node().select_first("p.a").content() == "x");
+}
+
+TEST_GROUP(structural_index) {
+    auto xml = Records(200);
+    using Index = LXml::StructuralIndex;
+    auto scalar = Index::Build(xml,Index::Isa::Scalar);
+    auto best = Index::Build(xml);
+    CHECK(scalar.offset_count() == best.offset_count());
+    CHECK(std::equal(scalar.offsets(),scalar.offsets() + scalar.offset_count(),best.offsets()));
+    CHECK(best.balanced());
+    CHECK(best.count("item") == 200);
+    CHECK(best.count("name") == 200);
+    CHECK(best.element_count() == 401);
+    CHECK(best.max_depth() == 3);
+    CHECK(!Index::Build("<r><a></r>").balanced());
+
+    //Quotes and comments hide the markup
+    auto tricky = Index::Build("<r a='<b>'><!-- <c> --><![CDATA[<d>]]><e/></r>");
+    CHECK(tricky.count("b") == 0);
+    CHECK(tricky.count("c") == 0);
+    CHECK(tricky.count("d") == 0);
+    CHECK(tricky.count("e") == 1);
+}
+
+#if LXML_CXX20
+namespace {
+
+LXml::AsyncTask<size_t> CountItems(LXml::u8string_view xml,size_t chunk,int opt = LXml::DefaultOptions) {
+    LXml::MemoryStream stream(xml,chunk);
+    auto doc = co_await LXml::AsyncParse(stream,opt);
+    co_return doc.freeze().query("/root/item").size();
+}
+
+}
+
+TEST_GROUP(async_parse) {
+    auto xml = Records(100);
+    for(size_t chunk : {1,64,1 << 20}){
+        auto task = CountItems(xml,chunk);
+        task.start();
+        CHECK(task.done());
+        CHECK(task.result() == 100);
+    }
+    //Recovered,then the error of a strict parse is rethrown by result()
+    auto broken = CountItems("<root><item>",16);
+    broken.start();
+    CHECK(broken.done());
+    CHECK(broken.result() == 1);
+    auto strict = CountItems("<root><item>",16,LXml::NoError | LXml::NoWarning);
+    strict.start();
+    CHECK(strict.done());
+    bool failed = false;
+    try{
+        strict.result();
+    }
+    catch(std::runtime_error &){
+        failed = true;
+    }
+    CHECK(failed);
+}
+#endif
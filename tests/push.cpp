@@ -0,0 +1,47 @@
+#include "test.hpp"
+#include <string>
+
+TEST_GROUP(push) {
+    std::string xml = "<?xml version='1.0'?><root>";
+    for(size_t i = 0;i < 500;i++){
+        xml += "<item id='" + std::to_string(i) + "'>text &amp; more</item>";
+    }
+    xml += "</root>";
+
+    //Split everywhere,inside names,attributes and references
+    LXml::XmlPushParser parser;
+    for(size_t step : {1,7,4096}){
+        bool fed = true;
+        for(size_t pos = 0;pos < xml.size();pos += step){
+            fed = parser.feed(LXml::u8string_view(xml).substr(pos,step)) && fed;
+        }
+        CHECK(fed);
+        CHECK(parser.feed(LXml::u8string_view()));
+        auto doc = parser.finish();
+        CHECK(doc.root_node().name_view() == "root");
+        CHECK(doc.freeze().query("/root/item").size() == 500);
+        CHECK(doc.root_node().xpath_first("item[500]").attribute("id") == "499");
+        CHECK(doc.root_node().xpath_first("item[1]").content() == "text & more");
+        CHECK(parser.get() == nullptr);
+    }
+
+    LXml::HtmlPushParser html;
+    CHECK(html.feed("<html><body><p class='a'>one"));
+    CHECK(html.feed("</p><p>two</p></bo"));
+    CHECK(html.feed("dy></html>"));
+    auto page = html.finish();
+    CHECK(page.root_node().select_first("p.a").content() == "one");
+
+    //Without Recover a broken document fails
+    LXml::XmlPushParser strict(LXml::NoError | LXml::NoWarning);
+    strict.feed("<r><a></r>");
+    bool failed = false;
+    try{
+        strict.finish();
+    }
+    catch(std::runtime_error &){
+        failed = true;
+    }
+    CHECK(failed);
+    CHECK(strict.get() == nullptr);
+}
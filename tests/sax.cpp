@@ -0,0 +1,64 @@
+#include "test.hpp"
+#include <map>
+
+namespace {
+
+struct Collect {
+    std::map<LXml::u8string,LXml::u8string> attrs;
+    LXml::u8string                          text;
+    size_t                                  starts = 0;
+    size_t                                  ends = 0;
+
+    void on_start_element(LXml::u8string_view,LXml::SAXAttributes list) {
+        starts++;
+        for(auto attr : list){
+            attrs[LXml::u8string(attr.name)] = LXml::u8string(attr.value);
+        }
+    }
+    void on_end_element(LXml::u8string_view) {
+        ends++;
+    }
+    void on_text(LXml::u8string_view s) {
+        text.append(s.data(),s.size());
+    }
+};
+struct StartsOnly {
+    size_t starts = 0;
+    void on_start_element(LXml::u8string_view,LXml::SAXAttributes) {
+        starts++;
+    }
+};
+
+}
+
+TEST_GROUP(sax) {
+    const char *xml =
+        "<!DOCTYPE r [<!ENTITY e 'E'>]>"
+        "<r a='x&amp;y' b='a&#38;b' c='&#x41;&#66;&lt;&gt;&quot;&apos;' d='p&e;q' f='plain' g='&#x1F600;'>"
+        "t&amp;u<i/><![CDATA[<c>]]></r>";
+    Collect collect;
+    LXml::SAXParser<Collect> parser(collect);
+    CHECK(parser.parse(xml));
+    CHECK(collect.starts == 2);
+    CHECK(collect.ends == 2);
+    CHECK(collect.text == "t&u<c>");
+    CHECK(collect.attrs["a"] == "x&y");
+    CHECK(collect.attrs["b"] == "a&b");
+    CHECK(collect.attrs["c"] == "AB<>\"'");
+    CHECK(collect.attrs["d"] == "p&e;q");
+    CHECK(collect.attrs["f"] == "plain");
+    CHECK(collect.attrs["g"] == "\xF0\x9F\x98\x80");
+
+    //Substituted by libxml2,a literal & is not decoded again
+    Collect noent;
+    LXml::SAXParser<Collect> substitute(noent);
+    CHECK(substitute.parse("<!DOCTYPE r [<!ENTITY e 'E'>]><r a='x&amp;lt;' d='p&e;q'/>",LXml::DefaultOptions | LXml::NoEntities));
+    CHECK(noent.attrs["a"] == "x&lt;");
+    CHECK(noent.attrs["d"] == "pEq");
+
+    StartsOnly starts;
+    LXml::SAXParser<StartsOnly> only(starts);
+    CHECK(only.parse("<r><a/><b><c/></b></r>"));
+    CHECK(starts.starts == 4);
+    CHECK(!only.parse("<r><a></r>",LXml::NoError | LXml::NoWarning));
+}
@@ -0,0 +1,58 @@
+#include "test.hpp"
+
+TEST_GROUP(select) {
+    auto html = LXml::HtmlDocument::Parse(
+        "<html><body>"
+        "<div class='item row' id='first'><a href='/a' class='link'>A</a><p>one <b>bold</b></p></div>"
+        "<div class='item'><a href='/b?x=1&amp;y=2' class='link other'>B</a></div>"
+        "<DIV class='x'><SPAN lang='en-US'>C</SPAN></DIV>"
+        "</body></html>"
+    );
+    auto root = html.root_node();
+    auto count = [&](LXml::u8string_view css){
+        size_t n = 0;
+        for(auto node : root.select(css)){
+            n += node.is_element();
+        }
+        return n;
+    };
+    CHECK(count("div") == 3);
+    CHECK(count(".link") == 2);
+    CHECK(count("div.item > a.link") == 2);
+    CHECK(count("div p b") == 1);
+    CHECK(count("#first a") == 1);
+    CHECK(count("a[href^='/b']") == 1);
+    CHECK(count("span[lang|=en]") == 1);
+    CHECK(count("a.link.other") == 1);
+    CHECK(count("div:first-child") == 1);
+    CHECK(count("a, b") == 3);
+    //Html names are compared without case
+    CHECK(count("DIV") == 3);
+    CHECK(count("span[LANG]") == 1);
+    //Entities in the value
+    CHECK(root.select_first("a[href='/b?x=1&y=2']").attribute("href") == "/b?x=1&y=2");
+    CHECK(root.select_first("p").select_first("b").content() == "bold");
+    CHECK(root.select_first("table").is_null());
+    CHECK(LXml::Selector::Compile("div >").is_null());
+    CHECK(LXml::Selector::Compile("a:hover").is_null());
+
+    auto link = root.select_first("a.other");
+    CHECK(link.matches(LXml::Selector::Compile("div > a")));
+    CHECK(!link.matches(LXml::Selector::Compile("p a")));
+
+    //Xml names are case sensitive,entity valued attributes compare by their value
+    auto xml = LXml::XmlDocument::Parse(
+        "<!DOCTYPE r [<!ENTITY e 'ENT'>]>"
+        "<r><Item href='x&e;y'/><item href='plain'/></r>"
+    );
+    auto xroot = xml.root_node();
+    size_t items = 0;
+    for(auto node : xroot.select("item")){
+        items += node.is_element();
+    }
+    CHECK(items == 1);
+    CHECK(xroot.select_first("Item").attribute("href") == "xENTy");
+    CHECK(!xroot.select_first("[href=xENTy]").is_null());
+    CHECK(xroot.select_first("[href=xENTy]").name_view() == "Item");
+    CHECK(xroot.select_first("[HREF=plain]").is_null());
+}
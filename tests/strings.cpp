@@ -0,0 +1,63 @@
+#include "test.hpp"
+
+TEST_GROUP(lstring) {
+    auto make = [](const char *s){
+        return LXml::lstring(xmlStrdup(BAD_CAST s));
+    };
+    LXml::lstring a = make("hello");
+    CHECK(a.size() == 5);
+    CHECK(a.view() == "hello");
+
+    //Move construct
+    LXml::lstring b(std::move(a));
+    CHECK(b.size() == 5);
+    CHECK(b.view() == "hello");
+    CHECK(a.is_null());
+    CHECK(a.size() == 0);
+
+    //Move assign,into empty and into a non empty string
+    LXml::lstring c;
+    c = std::move(b);
+    CHECK(c.size() == 5);
+    CHECK(c.view() == "hello");
+    CHECK(b.is_null());
+    LXml::lstring d = make("other string");
+    d = std::move(c);
+    CHECK(d.size() == 5);
+    CHECK(d == "hello");
+    d = make("assigned temporary");
+    CHECK(d.size() == 18);
+    CHECK(d.view() == "assigned temporary");
+
+    //Copy
+    LXml::lstring e(d);
+    CHECK(e == d);
+    LXml::lstring f;
+    f = e;
+    CHECK(f.view() == "assigned temporary");
+    CHECK(f.get() != e.get());
+
+    //Release / reset
+    xmlChar *raw = f.release();
+    CHECK(f.is_null() && f.size() == 0);
+    f.reset(raw);
+    CHECK(f.size() == 18);
+
+    CHECK(LXml::lstring().view().empty());
+    CHECK(std::string(LXml::lstring().c_str()).empty());
+}
+
+TEST_GROUP(views) {
+    auto doc  = LXml::XmlDocument::Parse("<!DOCTYPE r [<!ENTITY e 'E'>]><r a='1' b='x&e;y' c='x&amp;y'>text</r>");
+    auto root = doc.root_node();
+    CHECK(root.name_view() == "r");
+    CHECK(root.attribute_view("a") == "1");
+    //Not a single text node,only the owning accessor works
+    CHECK(root.attribute_view("b").empty());
+    CHECK(root.attribute("b") == "xEy");
+    CHECK(root.attribute("b").size() == 3);
+    CHECK(root.attribute("c") == "x&y");
+    CHECK(root.content() == "text");
+    CHECK(root.first_child().value_view() == "text");
+    CHECK(root.attribute("missing").is_null());
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../include/lxml.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//--Test harness
+//  Every group runs its checks,a failed check prints file:line and the expression,
+//  the process exits with the number of failed checks
+namespace Test {
+
+using Group = void (*)();
+
+inline std::vector<std::pair<const char *,Group>> &Groups() {
+    static std::vector<std::pair<const char *,Group>> groups;
+    return groups;
+}
+inline size_t &Failures() {
+    static size_t failures = 0;
+    return failures;
+}
+inline size_t &Checks() {
+    static size_t checks = 0;
+    return checks;
+}
+struct Register {
+    Register(const char *name,Group group) {
+        Groups().emplace_back(name,group);
+    }
+};
+inline bool Check(bool ok,const char *expr,const char *file,int line) {
+    Checks()++;
+    if(!ok){
+        Failures()++;
+        std::printf("%s:%d: check failed: %s\n",file,line,expr);
+    }
+    return ok;
+}
+
+}
+
+#define TEST_GROUP(NAME) \
+    static void Test_##NAME(); \
+    static Test::Register Test_##NAME##_register(#NAME,Test_##NAME); \
+    static void Test_##NAME()
+
+#define CHECK(EXPR) Test::Check(static_cast<bool>(EXPR),#EXPR,__FILE__,__LINE__)
@@ -0,0 +1,175 @@
+#include "test.hpp"
+#include <sstream>
+#include <string>
+
+//Every sink gets the same bytes as to_string()
+TEST_GROUP(output_sink) {
+    auto doc  = LXml::XmlDocument::Parse("<r><a n='1'>x&amp;y</a><b/></r>");
+    auto text = doc.to_string(false);
+
+    LXml::u8string str;
+    CHECK(doc.write_to(str,false));
+    CHECK(str == text);
+    std::ostringstream stream;
+    CHECK(doc.write_to(stream,false));
+    CHECK(stream.str() == text);
+
+    for(size_t chunk : {0,1,7,1 << 16}){
+        LXml::u8string joined;
+        size_t         calls = 0;
+        bool           sized = true;
+        CHECK(doc.write_to(LXml::OutputSink([&](LXml::u8string_view data){
+            calls++;
+            sized = sized && !data.empty() && data.size() <= (chunk == 0 ? 1 : chunk);
+            joined.append(data.data(),data.size());
+            return true;
+        },chunk),false));
+        CHECK(joined == text);
+        CHECK(sized);
+        CHECK(calls > 0);
+    }
+    CHECK(doc.root_node().select_first("a").to_string(false) == "<a n=\"1\">x&amp;y</a>");
+
+    //A callback returning false aborts
+    CHECK(!doc.write_to(LXml::OutputSink([](LXml::u8string_view){ return false; },4),false));
+}
+
+//XmlWriter output parsed back by libxml2
+TEST_GROUP(writer) {
+    LXml::u8string out;
+    {
+        LXml::XmlWriter writer(out,16);
+        writer.start_document();
+        writer.start_element("root");
+        writer.attribute("quote","a\"b<c>&'d");
+        writer.attribute("n",42);
+        writer.attribute("x",1.5);
+        writer.start_element("empty");
+        writer.end_element();
+        writer.element("text","1 < 2 && 3 > 2");
+        writer.start_element("mixed");
+        writer.text("a");
+        writer.comment("note");
+        writer.cdata("x]]>y");
+        writer.text(7);
+        writer.end_element();
+        writer.start_element("open");
+        writer.start_element("deep");
+        CHECK(writer.depth() == 3);
+        CHECK(writer.end_document());
+        CHECK(writer.good());
+        CHECK(writer.bytes_written() == out.size());
+    }
+    CHECK(out.find("<empty/>") != LXml::u8string::npos);
+
+    auto doc = LXml::XmlDocument::Parse(out,LXml::NoError | LXml::NoWarning);
+    auto root = doc.root_node();
+    CHECK(root.name_view() == "root");
+    CHECK(root.attribute("quote") == "a\"b<c>&'d");
+    CHECK(root.attribute("n") == "42");
+    CHECK(root.attribute("x") == "1.5");
+    CHECK(root.select_first("text").content() == "1 < 2 && 3 > 2");
+    CHECK(root.select_first("mixed").content() == "ax]]>y7");
+    CHECK(!root.xpath_first("open/deep").is_null());
+
+    //Chunks of a callback sink,and a writer reset to another sink (declared before,the writer flushes on destruction)
+    std::ostringstream stream;
+    size_t             chunks = 0;
+    LXml::u8string     joined;
+    LXml::XmlWriter writer(LXml::OutputSink([&](LXml::u8string_view chunk){
+        chunks++;
+        joined.append(chunk.data(),chunk.size());
+        return true;
+    },8),4);
+    writer.start_element("r");
+    for(int i = 0;i < 20;i++){
+        writer.element("i",std::to_string(i));
+    }
+    CHECK(writer.end_document());
+    CHECK(chunks > 1);
+    CHECK(LXml::XmlDocument::Parse(joined).freeze().query("/r/i").size() == 20);
+
+    writer.reset(stream);
+    writer.element("s","v");
+    CHECK(writer.end_document());
+    CHECK(stream.str() == "<s>v</s>");
+
+    //A failing sink is reported
+    LXml::XmlWriter failing(LXml::OutputSink([](LXml::u8string_view){ return false; },4),4);
+    failing.element("a","bbbbbbbb");
+    CHECK(!failing.end_document());
+    CHECK(!failing.good());
+}
+
+TEST_GROUP(builder) {
+    auto doc = LXml::XmlDocument::New();
+    LXml::DocumentBuilder builder(doc);
+    builder.start_element("rows");
+    builder.attribute("kind","a&b");
+    for(int i = 0;i < 3;i++){
+        builder.start_element("row");
+        builder.attribute("id",i);
+        builder.text("t<" + std::to_string(i) + ">");
+        builder.end_element();
+    }
+    auto empties = builder.append_elements("empty",4);
+    CHECK(empties.name_view() == "empty");
+    builder.element("last","end");
+    CHECK(builder.current().name_view() == "rows");
+    builder.end_element();
+    CHECK(builder.current().is_null());
+
+    auto root = doc.root_node();
+    CHECK(root.name_view() == "rows");
+    CHECK(root.attribute("kind") == "a&b");
+    CHECK(root.xpath_first("row[@id='2']").content() == "t<2>");
+    CHECK(doc.freeze().query("/rows/empty").size() == 4);
+    CHECK(doc.freeze().query("/rows/*").size() == 8);
+    //Names come from the dict
+    auto row = root.select_first("row");
+    CHECK(doc.get()->dict == nullptr || xmlDictOwns(doc.get()->dict,row.get()->name) == 1);
+    CHECK(row.get()->name == root.xpath_first("row[2]").get()->name);
+
+    //Continue in an existing element
+    builder.set_current(row);
+    builder.element("sub","x");
+    CHECK(root.xpath_first("row[1]/sub").content() == "x");
+
+    //The serialization parses back to the same tree (the declaration gains the encoding)
+    auto text = doc.to_string(false);
+    auto again = LXml::XmlDocument::Parse(text).to_string(false);
+    CHECK(again.substr(again.find("<rows")) == text.substr(text.find("<rows")));
+    LXml::u8string sink;
+    CHECK(doc.write_to(sink,false));
+    CHECK(sink == text);
+
+    //A second root is refused,the tree built so far is kept
+    auto parsed = LXml::XmlDocument::Parse("<a/>");
+    LXml::DocumentBuilder again_builder(parsed);
+    again_builder.end_element();
+    CHECK(again_builder.current().is_null());
+    bool refused = false;
+    try{
+        again_builder.start_element("b");
+    }
+    catch(std::runtime_error &){
+        refused = true;
+    }
+    CHECK(refused);
+    CHECK(parsed.root_node().name_view() == "a");
+    CHECK(parsed.to_string(false).find("<a/>") != LXml::u8string::npos);
+}
+
+TEST_GROUP(create_element) {
+    auto doc = LXml::XmlDocument::Parse("<p:a xmlns:p='urn:p'/>");
+    auto root = doc.root_node();
+    auto child = root.create_element("b");
+    CHECK(child.get()->ns == root.get()->ns);
+    CHECK(root.first_child().name_view() == "b");
+
+    //On the document node,the xmlDoc has no ns to inherit
+    auto top = root.parent().create_element("c");
+    CHECK(!top.is_null());
+    CHECK(top.get()->ns == nullptr);
+    CHECK(doc.to_string(false).find("<c/>") != LXml::u8string::npos);
+}
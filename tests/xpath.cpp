@@ -0,0 +1,172 @@
+#include "test.hpp"
+#include <random>
+#include <string>
+#include <thread>
+
+TEST_GROUP(xpath_context) {
+    auto doc = LXml::XmlDocument::Parse("<r xmlns:p='urn:p'><a n='1'/><a n='2'/><p:b/></r>");
+    auto root = doc.root_node();
+    LXml::XPathContent ctxt(doc);
+
+    //Integral values are numbers,not booleans
+    CHECK(ctxt.register_variable("n",2));
+    CHECK(ctxt.eval(root,"count(a[@n = $n])").as_number() == 1);
+    CHECK(ctxt.register_variable("n",size_t(1)));
+    CHECK(ctxt.eval(root,"string(a[@n = $n]/@n)").as_string().view() == "1");
+    CHECK(ctxt.register_variable("f",true));
+    CHECK(ctxt.eval(root,"$f").as_boolean());
+    CHECK(ctxt.register_variable("d",1.5));
+    CHECK(ctxt.eval(root,"$d * 2").as_number() == 3);
+    CHECK(ctxt.register_namespace("q","urn:p"));
+    CHECK(ctxt.eval(root,"count(q:b)").as_number() == 1);
+
+    //Rebinding drops the variables and namespaces of the old document
+    auto other = LXml::XmlDocument::Parse("<r><a n='1'/></r>");
+    CHECK(ctxt.register_variable("node",root));
+    ctxt.reset(other);
+    CHECK(ctxt.eval(other.root_node(),"$node").is_null());
+    CHECK(ctxt.eval(other.root_node(),"count(q:b)").is_null());
+    CHECK(ctxt.eval(other.root_node(),"count(a)").as_number() == 1);
+
+    //The thread local context follows the node
+    CHECK(root.xpath("count(a)").as_number() == 2);
+    CHECK(other.root_node().xpath("count(a)").as_number() == 1);
+    CHECK(root.xpath("$n").is_null());
+
+    size_t found = 0;
+    std::thread worker([&](){
+        auto local = LXml::XmlDocument::Parse("<r><a/><a/><a/></r>");
+        found = local.root_node().xpath("//a").as_nodeset().size();
+    });
+    worker.join();
+    CHECK(found == 3);
+}
+
+namespace {
+
+//Random tree of a few names,attributes with a few values
+void Grow(LXml::u8string &out,std::mt19937 &rng,size_t depth) {
+    static const char *names[] = {"a","b","c"};
+    size_t children = rng() % 4;
+    for(size_t i = 0;i < children;i++){
+        const char *name = names[rng() % 3];
+        out += '<';
+        out += name;
+        if(rng() % 2){
+            out += " k='" + std::to_string(rng() % 3) + "'";
+        }
+        out += '>';
+        if(depth < 4){
+            Grow(out,rng,depth + 1);
+        }
+        out += "</";
+        out += name;
+        out += '>';
+    }
+}
+LXml::u8string RandomPath(std::mt19937 &rng) {
+    static const char *names[] = {"a","b","c","*"};
+    LXml::u8string path = rng() % 2 ? "/" : "";
+    size_t steps = 1 + rng() % 3;
+    for(size_t i = 0;i < steps;i++){
+        if(i > 0 || !path.empty()){
+            path += rng() % 2 ? "//" : "/";
+        }
+        else if(rng() % 2){
+            path += ".//";
+        }
+        path += names[rng() % 4];
+        switch(rng() % 5){
+            case 0 : path += "[@k]"; break;
+            case 1 : path += "[@k='" + std::to_string(rng() % 3) + "']"; break;
+            case 2 : path += "[" + std::to_string(1 + rng() % 2) + "]"; break;
+            default : break;
+        }
+    }
+    if(path.compare(0,3,"///") == 0 || path == "/"){
+        path = "//a";
+    }
+    return path;
+}
+bool IsNative(const char *path) {
+    return LXml::Detail::NativePath::Compile(path).is_native();
+}
+
+}
+
+//xpath_first / xpath_exists against the first node of libxml2's result
+TEST_GROUP(xpath_first) {
+    std::mt19937 rng(20241016);
+    size_t mismatched = 0;
+    for(size_t round = 0;round < 100;round++){
+        LXml::u8string xml = "<r>";
+        Grow(xml,rng,0);
+        xml += "</r>";
+        auto doc = LXml::XmlDocument::Parse(xml);
+        auto root = doc.root_node();
+        for(size_t q = 0;q < 20;q++){
+            auto path = RandomPath(rng);
+            auto obj = root.xpath(path);
+            LXml::NodeRef expected;
+            if(!obj.is_null() && obj.is_nodeset() && obj.as_nodeset().size() > 0){
+                expected = obj.as_nodeset()[0];
+            }
+            bool ok = root.xpath_first(path).get() == expected.get() && root.xpath_exists(path) == !expected.is_null();
+            if(!ok && mismatched++ < 5){
+                std::printf("  %s on %s\n",path.c_str(),xml.c_str());
+            }
+        }
+    }
+    CHECK(mismatched == 0);
+
+    //Out of the subset,compiled once and cached like the native paths
+    auto doc = LXml::XmlDocument::Parse("<r><a k='1'/><a k='2'/><b/></r>");
+    auto root = doc.root_node();
+    auto &cache = LXml::Detail::NativePathCache();
+    CHECK(root.xpath_first("a[last()]").attribute("k") == "2");
+    size_t misses = cache.miss_count();
+    CHECK(root.xpath_first("a[last()]").attribute("k") == "2");
+    CHECK(root.xpath_exists("count(a) = 2"));
+    CHECK(root.xpath_exists("count(a) = 2"));
+    CHECK(!root.xpath_exists("count(b) = 2"));
+    CHECK(cache.miss_count() == misses + 2);
+    CHECK(root.xpath_first("a[").is_null());
+    CHECK(!root.xpath_exists("a["));
+    CHECK(root.xpath_first("count(a)").is_null());
+
+    //Numbers are not names,libxml2 evaluates them
+    CHECK(root.xpath_exists("1"));
+    CHECK(root.xpath_exists("-1"));
+    CHECK(!root.xpath_exists("0"));
+    CHECK(root.xpath_exists(".5"));
+    CHECK(root.xpath_first("-1").is_null());
+    CHECK(root.xpath_first("1").is_null());
+    CHECK(!IsNative("1") && !IsNative("-1") && !IsNative("a/1") && !IsNative("a[@1]"));
+    CHECK(IsNative("a/_b") && IsNative("//a[@k='1']"));
+}
+
+TEST_GROUP(xpath_cache) {
+    auto doc = LXml::XmlDocument::Parse("<r><a/><a/><b/></r>");
+    auto root = doc.root_node();
+    auto compiled = LXml::XPathExpression::Compile("count(a)");
+    CHECK(!compiled.is_null());
+    LXml::XPathContent ctxt(doc);
+    CHECK(ctxt.eval(root,compiled).as_number() == 2);
+
+    LXml::XPathCache cache(2);
+    auto first = cache.get("//a");
+    CHECK(first != nullptr);
+    CHECK(cache.get("//a") == first);
+    CHECK(cache.hit_count() == 1);
+    CHECK(cache.get("//b") != nullptr);
+    CHECK(cache.get("//c") != nullptr);
+    CHECK(cache.size() == 2);
+    CHECK(cache.get("//a") != first);
+    CHECK(cache.get("//[") == nullptr);
+    CHECK(cache.size() == 2);
+    cache.set_capacity(0);
+    CHECK(cache.size() == 0);
+    CHECK(cache.get("//a") != nullptr);
+    CHECK(cache.size() == 0);
+    CHECK(root.xpath("//a").as_nodeset().size() == 2);
+}
@@ -8,6 +8,26 @@ target("test")
     set_kind("binary")
     add_files("test.cpp")
 
+target("tests")
+    set_kind("binary")
+    set_languages("c++20")
+    add_files("tests/*.cpp")
+    add_syslinks("pthread")
+
+target("bench")
+    set_kind("binary")
+    set_languages("c++20")
+    set_optimize("fastest")
+    add_files("bench/*.cpp")
+    add_syslinks("pthread")
+
+target("bench_arena")
+    set_kind("binary")
+    set_languages("c++20")
+    set_optimize("fastest")
+    add_files("bench/arena/*.cpp","bench/alloc.cpp")
+    add_syslinks("pthread")
+
 --
 -- If you want to known more usage about xmake, please see https://xmake.io
 --